@@ -0,0 +1,265 @@
+#include <benchmark/benchmark.h>
+
+#include <big_integer.hpp>
+#include <fixed_big_integer.hpp>
+#include <mod_context.hpp>
+#include <multiplication.hpp>
+#include <thread_pool.hpp>
+
+#include <random>
+#include <string>
+
+namespace big_numbers {
+
+namespace {
+
+// Operand sizes in decimal digits: 1, 10, ..., 10^6
+constexpr std::int64_t kMinDigits = 1;
+constexpr std::int64_t kMaxDigits = 1'000'000;
+
+std::string RandomDigits(std::size_t count, std::uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> digit('0', '9');
+    std::string res(count, '0');
+    for (auto& c : res) {
+        c = static_cast<char>(digit(gen));
+    }
+    res[0] = static_cast<char>(std::uniform_int_distribution<int>('1', '9')(gen));
+    return res;
+}
+
+BigInteger RandomNumber(std::size_t digits, std::uint32_t seed) {
+    return BigInteger(RandomDigits(digits, seed));
+}
+
+void BM_Add(benchmark::State& state) {
+    BigInteger lhs = RandomNumber(state.range(0), 1);
+    BigInteger rhs = RandomNumber(state.range(0), 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs + rhs);
+    }
+}
+
+void BM_Sub(benchmark::State& state) {
+    BigInteger lhs = RandomNumber(state.range(0), 1);
+    BigInteger rhs = RandomNumber(state.range(0), 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs - rhs);
+    }
+}
+
+void BM_AddAssign(benchmark::State& state) {
+    BigInteger acc = RandomNumber(state.range(0), 1);
+    BigInteger rhs = RandomNumber(state.range(0), 2);
+    for (auto _ : state) {
+        acc += rhs;
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_Mul(benchmark::State& state) {
+    BigInteger lhs = RandomNumber(state.range(0), 1);
+    BigInteger rhs = RandomNumber(state.range(0), 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs * rhs);
+    }
+}
+
+// Product of two numbers of n digits with a pool of arg1 threads, 0 runs it serially
+void BM_ParallelMul(benchmark::State& state) {
+    BigInteger lhs = RandomNumber(state.range(0), 1);
+    BigInteger rhs = RandomNumber(state.range(0), 2);
+    ThreadPool pool(state.range(1));
+    limbs::GetMulParallel().pool = state.range(1) > 0 ? &pool : nullptr;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs * rhs);
+    }
+    limbs::GetMulParallel().pool = nullptr;
+}
+
+void BM_Sqr(benchmark::State& state) {
+    BigInteger value = RandomNumber(state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value * value);
+    }
+}
+
+// Power of a number of n digits with a result of about 10^5 digits
+void BM_Pow(benchmark::State& state) {
+    BigInteger value = RandomNumber(state.range(0), 1);
+    BigInteger exponent = static_cast<int>(100'000 / state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value.Pow(exponent));
+    }
+}
+
+// Base, exponent and an odd (Montgomery) or even modulus of n digits each
+void BM_PowMod(benchmark::State& state) {
+    BigInteger base = RandomNumber(state.range(0), 1);
+    BigInteger exponent = RandomNumber(state.range(0), 2);
+    BigInteger modulus = RandomNumber(state.range(0), 3);
+    if ((modulus % 2 == 1) != (state.range(1) == 1)) {
+        modulus += 1;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(base.PowMod(exponent, modulus));
+    }
+}
+
+// x = x * y mod m with all three of n digits, by % after the product or in a ModContext
+void BM_ModMul(benchmark::State& state) {
+    BigInteger modulus = RandomNumber(state.range(0), 3);
+    BigInteger lhs = RandomNumber(state.range(0), 1) % modulus;
+    BigInteger rhs = RandomNumber(state.range(0), 2) % modulus;
+    if (state.range(1) == 0) {
+        for (auto _ : state) {
+            lhs = lhs * rhs % modulus;
+        }
+        return;
+    }
+    ModContext context(modulus);
+    ModContext::Residue x = context.Enter(lhs);
+    ModContext::Residue y = context.Enter(rhs);
+    for (auto _ : state) {
+        x = context.Mul(std::move(x), y);
+    }
+    benchmark::DoNotOptimize(context.Leave(x));
+}
+
+// a * b + c of 36 digit operands in BigInteger or FixedBigInteger<256>, arg 0 or 1
+void BM_FixedMulAdd(benchmark::State& state) {
+    BigInteger lhs = RandomNumber(36, 1);
+    BigInteger rhs = RandomNumber(36, 2);
+    BigInteger acc = RandomNumber(36, 3);
+    if (state.range(0) == 0) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(lhs * rhs + acc);
+        }
+        return;
+    }
+    FixedBigInteger<256> fixed_lhs(lhs);
+    FixedBigInteger<256> fixed_rhs(rhs);
+    FixedBigInteger<256> fixed_acc(acc);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixed_lhs * fixed_rhs + fixed_acc);
+    }
+}
+
+// A number of 2n digits divided by a number of n digits
+void BM_Div(benchmark::State& state) {
+    BigInteger num = RandomNumber(2 * state.range(0), 1);
+    BigInteger den = RandomNumber(state.range(0), 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(num / den);
+    }
+}
+
+void BM_Mod(benchmark::State& state) {
+    BigInteger num = RandomNumber(2 * state.range(0), 1);
+    BigInteger den = RandomNumber(state.range(0), 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(num % den);
+    }
+}
+
+// Square root of a number of 2n digits, the cost of a division of 2n by n digits
+void BM_Sqrt(benchmark::State& state) {
+    BigInteger value = RandomNumber(2 * state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value.Sqrt());
+    }
+}
+
+// Gcd of two numbers of n digits by Lehmer's algorithm or by Euclid's with %, arg 0
+// or 1
+void BM_Gcd(benchmark::State& state) {
+    BigInteger lhs = RandomNumber(state.range(0), 1);
+    BigInteger rhs = RandomNumber(state.range(0), 2);
+    if (state.range(1) == 0) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(lhs.Gcd(rhs));
+        }
+        return;
+    }
+    for (auto _ : state) {
+        BigInteger a = lhs;
+        BigInteger b = rhs;
+        while (!(b == 0)) {
+            a = a % b;
+            std::swap(a, b);
+        }
+        benchmark::DoNotOptimize(a);
+    }
+}
+
+// Arithmetic with a machine integer, converted to a BigInteger first (0) or taken as
+// it is by the integral operators (1)
+void BM_SmallOperand(benchmark::State& state) {
+    BigInteger value = RandomNumber(state.range(0), 1);
+    int small = -1'000'000'007;
+    if (state.range(1) == 0) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(value * BigInteger(small) + BigInteger(small));
+            benchmark::DoNotOptimize(value / BigInteger(small));
+            benchmark::DoNotOptimize(value % BigInteger(small));
+        }
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value * small + small);
+        benchmark::DoNotOptimize(value / small);
+        benchmark::DoNotOptimize(value % small);
+    }
+}
+
+// Worst case: the operands differ only in the lowest digit
+void BM_Compare(benchmark::State& state) {
+    std::string digits = RandomDigits(state.range(0), 1);
+    BigInteger lhs(digits);
+    digits.back() = digits.back() == '9' ? '8' : static_cast<char>(digits.back() + 1);
+    BigInteger rhs(digits);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs < rhs);
+    }
+}
+
+void BM_ToString(benchmark::State& state) {
+    BigInteger value = RandomNumber(state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value.ToString());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Parse(benchmark::State& state) {
+    std::string digits = RandomDigits(state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BigInteger(digits));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_Add)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_Sub)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_AddAssign)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_Mul)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_ParallelMul)->ArgsProduct({{10'000, 100'000, 1'000'000}, {0, 4}});
+BENCHMARK(BM_Sqr)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_Pow)->RangeMultiplier(10)->Range(kMinDigits, 10'000);
+BENCHMARK(BM_PowMod)->ArgsProduct({{10, 100, 1000}, {1, 0}});
+BENCHMARK(BM_ModMul)->ArgsProduct({{10, 100, 1000, 10000}, {0, 1}});
+BENCHMARK(BM_FixedMulAdd)->Arg(0)->Arg(1);
+BENCHMARK(BM_Div)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_Mod)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_Sqrt)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_Gcd)->ArgsProduct({{10, 100, 1000, 10000}, {0, 1}});
+BENCHMARK(BM_SmallOperand)->ArgsProduct({{10, 100, 1000, 10000}, {0, 1}});
+BENCHMARK(BM_Compare)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_ToString)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+BENCHMARK(BM_Parse)->RangeMultiplier(10)->Range(kMinDigits, kMaxDigits);
+
+}  // namespace big_numbers
+
+BENCHMARK_MAIN();
@@ -1,8 +1,14 @@
 #include "big_integer.hpp"
-#include <iomanip>
-#include <sstream>
-#include <cctype>
+#include "digits.hpp"
+#include "division.hpp"
+#include "mod_context.hpp"
+#include "multiplication.hpp"
+#include "radix.hpp"
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
 
 namespace big_numbers {
 
@@ -11,197 +17,103 @@ namespace {
 using CellType = BigInteger::CellType;
 using ContainerType = BigInteger::ContainerType;
 
-CellType SumTwoCells(CellType lhs, CellType rhs, CellType& carry) {
-    CellType result = (lhs + rhs) % BigInteger::kModule;
-    carry += result < std::max(lhs, rhs);
-    return result;
-}
-
-CellType DifTwoCells(CellType lhs, CellType rhs, CellType& carry) {
-    carry += lhs < rhs;
-    return lhs >= rhs ? lhs - rhs : BigInteger::kModule - (rhs - lhs);
-}
-
-CellType MultTwoCells(CellType lhs, CellType rhs, CellType& carry) {
-    static constexpr CellType kModule = BigInteger::kModule;
-    static constexpr CellType kHalfModule = CalcModule(BigInteger::kWidth / 2);
-    CellType lhs_low = lhs % kHalfModule;
-    CellType rhs_low = rhs % kHalfModule;
-    CellType lhs_high = lhs / kHalfModule;
-    CellType rhs_high = rhs / kHalfModule;
-
-    CellType res_high = lhs_high * rhs_high;
-    CellType res_low = lhs_low * rhs_low;
-
-    CellType res_mid = (lhs_high + lhs_low) * (rhs_high + rhs_low) - res_high - res_low;
-
-    res_high += res_mid / kHalfModule;
-    res_low += (res_mid % kHalfModule) * kHalfModule;
-
-    carry += res_high + res_low / kModule;
-    return res_low % kModule;
-}
-
-ContainerType ModuleSum(const ContainerType& lhs, const ContainerType& rhs) {
-    ContainerType result;
-    CellType carry = 0;
-    auto lhs_iter = lhs.begin();
-    auto rhs_iter = rhs.begin();
-
-    while (lhs_iter != lhs.end() || rhs_iter != rhs.end() || carry != 0) {
-        CellType new_carry{0};
-        CellType lhs_cell = lhs_iter != lhs.end() ? *lhs_iter++ : 0;
-        CellType rhs_cell = rhs_iter != rhs.end() ? *rhs_iter++ : 0;
-
-        CellType res_cell = SumTwoCells(lhs_cell, rhs_cell, new_carry);
-        res_cell = SumTwoCells(res_cell, carry, new_carry);
-
-        result.emplace_back(res_cell);
-        carry = new_carry;
-    }
-
-    return result;
+std::size_t NormalizedSize(const ContainerType& container) {
+    return limbs::Normalize(container.data(), container.size());
 }
 
-ContainerType ModuleDif(const ContainerType& lhs, const ContainerType& rhs) {
-    ContainerType result;
-    CellType carry = 0;
-    auto lhs_iter = lhs.begin();
-    auto rhs_iter = rhs.begin();
-
-    while (lhs_iter != lhs.end() || carry != 0) {
-        CellType new_carry{0};
-        CellType lhs_cell = lhs_iter != lhs.end() ? *lhs_iter++ : 0;
-        CellType rhs_cell = rhs_iter != rhs.end() ? *rhs_iter++ : 0;
-
-        CellType res_cell = DifTwoCells(lhs_cell, rhs_cell, new_carry);
-        res_cell = DifTwoCells(res_cell, carry, new_carry);
-
-        result.emplace_back(res_cell);
-        carry = new_carry;
-    }
-
-    while (result.size() > 1 && result[result.size() - 1] == 0) {
-        result.pop_back();
-    }
-
-    return result;
-}
-
-ContainerType MultiplyOne(const ContainerType& other, CellType mult, std::size_t shift) {
-    ContainerType res(shift, 0);
-
-    CellType carry = 0;
-    for (auto& item : other) {
-        CellType new_carry{0};
-        CellType cur = MultTwoCells(item, mult, new_carry);
-        cur = SumTwoCells(cur, carry, new_carry);
-        res.emplace_back(cur % BigInteger::kModule);
-        carry = new_carry;
-    }
-
-    while (carry != 0) {
-        res.emplace_back(carry % BigInteger::kModule);
-        carry /= BigInteger::kModule;
-    }
-
-    return res;
+int AbsoluteCompare(const ContainerType& lhs, const ContainerType& rhs) {
+    return limbs::Compare(lhs.data(), NormalizedSize(lhs), rhs.data(), NormalizedSize(rhs));
 }
 
-template <typename Comparer>
-bool AbsoluteCompare(const ContainerType& lhs, const ContainerType& rhs) {
-    Comparer comp;
-
-    if (lhs.size() != rhs.size()) {
-        return comp(lhs.size(), rhs.size());
-    }
-
-    auto lhs_iter = lhs.rbegin();
-    auto rhs_iter = rhs.rbegin();
-
-    while (lhs_iter != lhs.rend() && *lhs_iter == *rhs_iter) {
-        lhs_iter++;
-        rhs_iter++;
-    }
-
-    return lhs_iter == lhs.rend() ? comp(1, 1) : comp(*lhs_iter, *rhs_iter);
+void TrimContainer(ContainerType& container) {
+    container.resize(std::max<std::size_t>(NormalizedSize(container), 1));
 }
 
 void AddContainer(ContainerType& lhs, const ContainerType& rhs) {
-    CellType carry = 0;
-    auto lhs_iter = lhs.begin();
-    auto rhs_iter = rhs.begin();
-
-    while (lhs_iter != lhs.end() || rhs_iter != rhs.end() || carry != 0) {
-        CellType new_carry{0};
-        CellType lhs_cell = lhs_iter != lhs.end() ? *lhs_iter : 0;
-        CellType rhs_cell = rhs_iter != rhs.end() ? *rhs_iter++ : 0;
-
-        CellType res_cell = SumTwoCells(lhs_cell, rhs_cell, new_carry);
-        res_cell = SumTwoCells(res_cell, carry, new_carry);
-
-        if (lhs_iter == lhs.end()) {
-            lhs.push_back(res_cell);
-            lhs_iter = lhs.end();
-        } else {
-            *lhs_iter++ = res_cell;
-        }
-        carry = new_carry;
+    // Room for the carry up front, so the cells move at most once
+    lhs.reserve(std::max(lhs.size(), rhs.size()) + 1);
+    if (lhs.size() < rhs.size()) {
+        lhs.resize(rhs.size(), 0);
+    }
+    CellType carry = limbs::Add(lhs.data(), lhs.data(), lhs.size(), rhs.data(), rhs.size());
+    if (carry != 0) {
+        lhs.push_back(carry);
     }
 }
 
+// lhs = lhs - rhs, |lhs| >= |rhs|
 void SubContainer(ContainerType& lhs, const ContainerType& rhs) {
-    CellType carry = 0;
-    auto lhs_iter = lhs.begin();
-    auto rhs_iter = rhs.begin();
-
-    while (lhs_iter != lhs.end() || carry != 0) {
-        CellType new_carry{0};
-        CellType lhs_cell = lhs_iter != lhs.end() ? *lhs_iter : 0;
-        CellType rhs_cell = rhs_iter != rhs.end() ? *rhs_iter++ : 0;
-
-        CellType res_cell = DifTwoCells(lhs_cell, rhs_cell, new_carry);
-        res_cell = DifTwoCells(res_cell, carry, new_carry);
-
-        if (lhs_iter == lhs.end()) {
-            lhs.push_back(res_cell);
-            lhs_iter = lhs.end();
-        } else {
-            *lhs_iter++ = res_cell;
-        }
-        carry = new_carry;
-    }
-
-    while (lhs.size() > 1 && *lhs.rbegin() == 0) {
-        lhs.pop_back();
-    }
+    std::size_t rhs_size = NormalizedSize(rhs);
+    limbs::Sub(lhs.data(), lhs.data(), lhs.size(), rhs.data(), rhs_size);
+    TrimContainer(lhs);
 }
 
+// lhs = rhs - lhs, |lhs| <= |rhs|
 void InvSubContainer(ContainerType& lhs, const ContainerType& rhs) {
-    CellType carry = 0;
-    auto lhs_iter = lhs.begin();
-    auto rhs_iter = rhs.begin();
-
-    while (rhs_iter != rhs.end() || carry != 0) {
-        CellType new_carry{0};
-        CellType lhs_cell = lhs_iter != lhs.end() ? *lhs_iter : 0;
-        CellType rhs_cell = rhs_iter != rhs.end() ? *rhs_iter++ : 0;
-
-        CellType res_cell = DifTwoCells(rhs_cell, lhs_cell, new_carry);
-        res_cell = DifTwoCells(res_cell, carry, new_carry);
-
-        if (lhs_iter == lhs.end()) {
-            lhs.push_back(res_cell);
-            lhs_iter = lhs.end();
-        } else {
-            *lhs_iter++ = res_cell;
+    std::size_t lhs_size = NormalizedSize(lhs);
+    lhs.resize(rhs.size(), 0);
+    CellType borrow = limbs::SubN(lhs.data(), rhs.data(), lhs.data(), lhs_size);
+    limbs::SubOne(lhs.data() + lhs_size, rhs.data() + lhs_size, rhs.size() - lhs_size, borrow);
+    TrimContainer(lhs);
+}
+
+/// Bits of the top of the numbers Lehmer's algorithm simulates Euclid's on, the
+/// cofactors then fit an std::int64_t
+constexpr std::size_t kLehmerBits = 62;
+/// Roots of at most these bits are started from a floating point estimate
+constexpr std::size_t kRootBasecaseBits = 32;
+
+/// Cofactors of a run of Euclid's quotients: the numbers u, v become
+/// a * u + b * v and c * u + d * v
+struct Cofactors {
+    std::int64_t a, b, c, d;
+};
+
+// Knuth's algorithm L. u and v are the top bits of the numbers from the same bit on,
+// so the numbers lie in [u, u + 1) and [v, v + 1) in units of that bit. A quotient
+// is taken only when both ends of the ranges give it. b is 0 when not even the first
+// quotient is known
+Cofactors LehmerCofactors(std::uint64_t u, std::uint64_t v) {
+    __int128 a = 1;
+    __int128 b = 0;
+    __int128 c = 0;
+    __int128 d = 1;
+    __int128 x = u;
+    __int128 y = v;
+    while (y + c != 0 && y + d != 0) {
+        __int128 quot = (x + a) / (y + c);
+        if (quot != (x + b) / (y + d)) {
+            break;
         }
-        carry = new_carry;
+        __int128 next = a - quot * c;
+        a = c;
+        c = next;
+        next = b - quot * d;
+        b = d;
+        d = next;
+        next = x - quot * y;
+        x = y;
+        y = next;
     }
-
-    while (lhs.size() > 1 && *lhs.rbegin() == 0) {
-        lhs.pop_back();
+    return {static_cast<std::int64_t>(a), static_cast<std::int64_t>(b),
+            static_cast<std::int64_t>(c), static_cast<std::int64_t>(d)};
+}
+
+/// Square root and remainder of high * 2^64 + low, from a floating point estimate
+std::pair<CellType, unsigned __int128> SqrtRemTwoCells(CellType low, CellType high) {
+    unsigned __int128 value = (static_cast<unsigned __int128>(high) << limbs::kCellBits) | low;
+    // Close below 2^128 the estimate rounds up to 2^64, which doesn't fit a cell
+    long double estimate = std::sqrt(static_cast<long double>(value));
+    CellType root = estimate < 0x1p64L ? static_cast<CellType>(estimate)
+                                       : std::numeric_limits<CellType>::max();
+    while (static_cast<unsigned __int128>(root) * root > value) {
+        --root;
+    }
+    while (root != std::numeric_limits<CellType>::max() &&
+           static_cast<unsigned __int128>(root + 1) * (root + 1) <= value) {
+        ++root;
     }
+    return {root, value - static_cast<unsigned __int128>(root) * root};
 }
 
 }  // namespace
@@ -210,15 +122,12 @@ BigInteger::BigInteger() : sign_(1), container_(1) {
 }
 
 BigInteger::BigInteger(std::int64_t init_value)
-    : BigInteger(static_cast<uint64_t>(std::abs(init_value))) {
+    : BigInteger(init_value < 0 ? ~static_cast<std::uint64_t>(init_value) + 1
+                                : static_cast<std::uint64_t>(init_value)) {
     sign_ = init_value < 0 ? -1 : 1;
 }
 
 BigInteger::BigInteger(std::uint64_t init_value) : sign_(1), container_(1, init_value) {
-    while (container_[container_.size() - 1] >= kModule) {
-        container_.emplace_back(container_[container_.size() - 1] / kModule);
-        container_[container_.size() - 2] %= kModule;
-    }
 }
 
 BigInteger::BigInteger(const std::string_view& str) {
@@ -226,28 +135,46 @@ BigInteger::BigInteger(const std::string_view& str) {
 }
 
 void BigInteger::ConstuctFromString(const std::string_view& str) {
-    container_.clear();
+    container_.assign(1, 0);
     sign_ = 1;
 
-    std::size_t idx = str.size();
-    while (idx - kWidth < idx) {
-        container_.emplace_back(std::stoul(std::string(str.substr(idx - kWidth, kWidth))));
-        idx -= kWidth;
+    if (str.empty() || str == "-") {
+        throw std::invalid_argument("BigInteger: empty number");
     }
-
-    std::string_view last = str.substr(str[0] == '-' ? 1 : 0, idx);
-    if (!last.empty()) {
-        container_.emplace_back(std::stoul(std::string(last)));
+    const char* last = str.data() + str.size();
+    if (FromChars(str.data(), last).ptr != last) {
+        throw std::invalid_argument("BigInteger: unexpected character in number");
     }
+}
 
-    if (!str.empty()) {
-        sign_ = str[0] == '-' ? -1 : 1;
+std::from_chars_result BigInteger::FromChars(const char* first, const char* last) {
+    const char* digits = first != last && *first == '-' ? first + 1 : first;
+    const char* end = limbs::ScanDigits(digits, last);
+    if (end == digits) {
+        return {first, std::errc::invalid_argument};
     }
+
+    ContainerType cells(limbs::DecimalCells(end - digits), 0, container_.resource());
+    std::size_t size = limbs::FromDecimal(cells.data(), digits, end - digits, cells.resource());
+    cells.resize(std::max<std::size_t>(size, 1));
+
+    sign_ = digits != first ? -1 : 1;
+    container_ = std::move(cells);
+    FixSign();
+    return {end, std::errc()};
+}
+
+BigInteger::BigInteger(std::pmr::memory_resource* resource)
+    : sign_(1), container_(1, 0, resource) {
 }
 
 BigInteger::BigInteger(const BigInteger& other) : sign_(other.sign_), container_(other.container_) {
 }
 
+BigInteger::BigInteger(const BigInteger& other, std::pmr::memory_resource* resource)
+    : sign_(other.sign_), container_(other.container_, resource) {
+}
+
 BigInteger::BigInteger(BigInteger&& other)
     : sign_(other.sign_), container_(std::move(other.container_)) {
 }
@@ -272,14 +199,7 @@ BigInteger& BigInteger::operator=(BigInteger&& other) {
 }
 
 BigInteger& BigInteger::operator=(std::int64_t other) {
-    sign_ = other < 0 ? -1 : 1;
-    container_.assign(1, other * sign_);
-    while (container_[container_.size() - 1] >= kModule) {
-        container_.emplace_back(container_[container_.size() - 1] / kModule);
-        container_[container_.size() - 2] %= kModule;
-    }
-
-    return *this;
+    return *this = BigInteger(other);
 }
 
 BigInteger& BigInteger::FixSign() {
@@ -289,13 +209,33 @@ BigInteger& BigInteger::FixSign() {
     return *this;
 }
 
-BigInteger& BigInteger::operator+=(const BigInteger& other) {
-    if (sign_ == other.sign_) {
+BigInteger& BigInteger::Trim() {
+    TrimContainer(container_);
+    return FixSign();
+}
+
+BigInteger& BigInteger::Negate() {
+    sign_ = -sign_;
+    return FixSign();
+}
+
+BigInteger BigInteger::CopyWithCapacity(std::size_t capacity) const {
+    ContainerType cells(container_.resource());
+    cells.reserve(std::max(capacity, container_.size()));
+    cells.resize(container_.size());
+    std::copy(container_.begin(), container_.end(), cells.begin());
+    return BigInteger(sign_, std::move(cells));
+}
+
+// *this += other taken with other_sign instead of its own sign, so -= needs no negated copy.
+// other may be *this
+BigInteger& BigInteger::AddSigned(const BigInteger& other, std::int8_t other_sign) {
+    if (sign_ == other_sign) {
         AddContainer(container_, other.container_);
-    } else if (AbsoluteCompare<More>(container_, other.container_)) {
+    } else if (AbsoluteCompare(container_, other.container_) > 0) {
         SubContainer(container_, other.container_);
     } else {
-        sign_ = other.sign_;
+        sign_ = other_sign;
         InvSubContainer(container_, other.container_);
         FixSign();
     }
@@ -303,92 +243,563 @@ BigInteger& BigInteger::operator+=(const BigInteger& other) {
     return *this;
 }
 
+BigInteger& BigInteger::operator+=(const BigInteger& other) {
+    return AddSigned(other, other.sign_);
+}
+
 BigInteger& BigInteger::operator-=(const BigInteger& other) {
-    return this->operator+=(-other);
+    return AddSigned(other, static_cast<std::int8_t>(-other.sign_));
 }
 
-BigInteger BigInteger::operator+(const BigInteger& other) const {
-    return BigInteger(*this) += other;
+BigInteger& BigInteger::AddCell(CellType value, std::int8_t sign) {
+    CellType* data = container_.data();
+    if (sign_ == sign) {
+        CellType carry = limbs::AddOne(data, data, container_.size(), value);
+        if (carry != 0) {
+            container_.push_back(carry);
+        }
+        return *this;
+    }
+    if (NormalizedSize(container_) > 1 || data[0] >= value) {
+        limbs::SubOne(data, data, container_.size(), value);
+        return Trim();
+    }
+    // |*this| < value, both fit one cell
+    data[0] = value - data[0];
+    sign_ = sign;
+    return *this;
 }
 
-BigInteger BigInteger::operator-(const BigInteger& other) const {
-    return BigInteger(*this) -= other;
+BigInteger BigInteger::operator+(const BigInteger& other) const& {
+    BigInteger res = CopyWithCapacity(std::max(container_.size(), other.container_.size()) + 1);
+    res += other;
+    return res;
 }
 
-BigInteger BigInteger::operator-() const {
-    BigInteger copy(*this);
-    copy.sign_ *= -1;
+BigInteger BigInteger::operator+(const BigInteger& other) && {
+    *this += other;
+    return std::move(*this);
+}
 
-    return copy.FixSign();
+BigInteger BigInteger::operator+(BigInteger&& other) const& {
+    other += *this;
+    return std::move(other);
+}
+
+BigInteger BigInteger::operator+(BigInteger&& other) && {
+    *this += other;
+    return std::move(*this);
+}
+
+BigInteger BigInteger::operator-(const BigInteger& other) const& {
+    BigInteger res = CopyWithCapacity(std::max(container_.size(), other.container_.size()) + 1);
+    res -= other;
+    return res;
+}
+
+BigInteger BigInteger::operator-(const BigInteger& other) && {
+    *this -= other;
+    return std::move(*this);
+}
+
+BigInteger BigInteger::operator-(BigInteger&& other) const& {
+    // this - other = -(other - this)
+    other -= *this;
+    other.Negate();
+    return std::move(other);
+}
+
+BigInteger BigInteger::operator-(BigInteger&& other) && {
+    *this -= other;
+    return std::move(*this);
+}
+
+BigInteger BigInteger::operator-() const& {
+    BigInteger copy(*this, Resource());
+    copy.Negate();
+    return copy;
+}
+
+BigInteger BigInteger::operator-() && {
+    Negate();
+    return std::move(*this);
 }
 
 BigInteger BigInteger::operator+() const {
-    return BigInteger(*this);
+    return BigInteger(*this, Resource());
 }
 
 BigInteger& BigInteger::operator*=(const BigInteger& other) {
-    BigInteger copy = *this * other;
-    sign_ = copy.sign_;
-    container_ = std::move(copy.container_);
+    // A one cell multiplier scales the cells in place
+    if (this != &other && NormalizedSize(other.container_) <= 1) {
+        CellType* data = container_.data();
+        CellType carry = limbs::MulOne(data, data, container_.size(), other.container_[0]);
+        if (carry != 0) {
+            container_.push_back(carry);
+        }
+        sign_ *= other.sign_;
+        return Trim();
+    }
+
+    BigInteger product = *this * other;
+    sign_ = product.sign_;
+    container_ = std::move(product.container_);
 
     return *this;
 }
 
-BigInteger BigInteger::operator*(const BigInteger& other) const {
-    BigInteger res;
-    res.sign_ = this->sign_ * other.sign_;
-    std::size_t shift = 0;
-    for (auto& item : this->container_) {
-        res += BigInteger(1, MultiplyOne(other.container_, item, shift++));
+BigInteger& BigInteger::MulCell(CellType value, std::int8_t sign) {
+    CellType* data = container_.data();
+    CellType carry = limbs::MulOne(data, data, container_.size(), value);
+    if (carry != 0) {
+        container_.push_back(carry);
     }
+    sign_ *= sign;
+    return Trim();
+}
 
-    return res;
+BigInteger BigInteger::operator*(const BigInteger& other) const& {
+    // Comparing the cells stops at the first difference, which is almost always the
+    // top cell of operands that are not equal
+    if (this == &other ||
+        (container_.size() == other.container_.size() &&
+         limbs::CompareN(container_.data(), other.container_.data(), container_.size()) == 0)) {
+        return SquareWithSign(this->sign_ * other.sign_);
+    }
+
+    const ContainerType& lhs =
+        container_.size() >= other.container_.size() ? container_ : other.container_;
+    const ContainerType& rhs =
+        container_.size() >= other.container_.size() ? other.container_ : container_;
+
+    ContainerType res(lhs.size() + rhs.size(), 0, container_.resource());
+    limbs::Mul(res.data(), lhs.data(), lhs.size(), rhs.data(), rhs.size(), res.resource());
+
+    // Trim() returns a reference, returning it would copy the cells
+    BigInteger product(this->sign_ * other.sign_, std::move(res));
+    product.Trim();
+    return product;
+}
+
+BigInteger BigInteger::Square() const {
+    return SquareWithSign(1);
+}
+
+BigInteger BigInteger::SquareWithSign(std::int8_t sign) const {
+    std::size_t size = NormalizedSize(container_);
+    if (size == 0) {
+        return BigInteger(Resource());
+    }
+    ContainerType res(2 * size, 0, container_.resource());
+    limbs::Sqr(res.data(), container_.data(), size, res.resource());
+    BigInteger square(sign, std::move(res));
+    square.Trim();
+    return square;
+}
+
+BigInteger BigInteger::operator*(const BigInteger& other) && {
+    *this *= other;
+    return std::move(*this);
+}
+
+// *this += sign * lhs * rhs. Below the Karatsuba threshold the rows of the schoolbook
+// product go straight into the cells of *this, larger products go through one scratch
+// buffer. Subtracting more than *this holds leaves a borrow out of the top cell: the
+// cells are then the two's complement of the result
+BigInteger& BigInteger::MulAccumulate(const BigInteger& lhs, const BigInteger& rhs,
+                                      std::int8_t sign) {
+    if (&lhs == this || &rhs == this) {
+        BigInteger product = lhs * rhs;
+        return AddSigned(product, static_cast<std::int8_t>(product.sign_ * sign));
+    }
+
+    std::size_t lhs_size = NormalizedSize(lhs.container_);
+    std::size_t rhs_size = NormalizedSize(rhs.container_);
+    const BigInteger& big = lhs_size >= rhs_size ? lhs : rhs;
+    const BigInteger& small = lhs_size >= rhs_size ? rhs : lhs;
+    std::size_t big_size = std::max(lhs_size, rhs_size);
+    std::size_t small_size = std::min(lhs_size, rhs_size);
+    if (small_size == 0) {
+        return *this;
+    }
+
+    const CellType* big_data = big.container_.data();
+    const CellType* small_data = small.container_.data();
+    bool add = sign_ == big.sign_ * small.sign_ * sign;
+    std::size_t size = std::max(container_.size(), big_size + small_size) + (add ? 1 : 0);
+    container_.resize(size, 0);
+    CellType* data = container_.data();
+
+    CellType borrow = 0;
+    if (small_size < limbs::GetMulThresholds().karatsuba) {
+        for (std::size_t i = 0; i < small_size; ++i) {
+            CellType* row = data + i;
+            if (add) {
+                CellType carry = limbs::AddMulOne(row, big_data, big_size, small_data[i]);
+                limbs::AddOne(row + big_size, row + big_size, size - i - big_size, carry);
+            } else {
+                CellType carry = limbs::SubMulOne(row, big_data, big_size, small_data[i]);
+                borrow +=
+                    limbs::SubOne(row + big_size, row + big_size, size - i - big_size, carry);
+            }
+        }
+    } else {
+        ContainerType product(big_size + small_size, 0, container_.resource());
+        limbs::Mul(product.data(), big_data, big_size, small_data, small_size,
+                   product.resource());
+        if (add) {
+            limbs::Add(data, data, size, product.data(), product.size());
+        } else {
+            borrow = limbs::Sub(data, data, size, product.data(), product.size());
+        }
+    }
+
+    if (borrow != 0) {
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] = ~data[i];
+        }
+        limbs::AddOne(data, data, size, 1);
+        sign_ = -sign_;
+    }
+
+    return Trim();
+}
+
+BigInteger& BigInteger::AddMul(const BigInteger& lhs, const BigInteger& rhs) {
+    return MulAccumulate(lhs, rhs, 1);
+}
+
+BigInteger& BigInteger::SubMul(const BigInteger& lhs, const BigInteger& rhs) {
+    return MulAccumulate(lhs, rhs, -1);
 }
 
 BigInteger BigInteger::operator/(const BigInteger& other) const {
-    BigInteger res;
-    BigInteger cur = *this;
-    if (other == BigInteger(0)) {
+    return DivMod(other).first;
+}
+
+BigInteger BigInteger::operator%(const BigInteger& other) const {
+    BigInteger result = DivMod(other).second;
+    if (result.sign_ < 0 && other.sign_ < 0) {
+        result -= other;
+    } else if (result.sign_ < 0) {
+        result += other;
+    }
+
+    return result;
+}
+
+BigInteger BigInteger::DivCell(CellType value, std::int8_t sign) const {
+    if (value == 0) {
+        throw std::logic_error("div by zero");
+    }
+    std::size_t size = NormalizedSize(container_);
+    ContainerType quot(std::max<std::size_t>(size, 1), 0, container_.resource());
+    limbs::DivRemOne(quot.data(), container_.data(), size, value);
+
+    BigInteger res(sign_ * sign, std::move(quot));
+    res.Trim();
+    return res;
+}
+
+BigInteger BigInteger::ModCell(CellType value) const {
+    if (value == 0) {
+        throw std::logic_error("div by zero");
+    }
+    CellType rem = limbs::ModOne(container_.data(), NormalizedSize(container_), value);
+    if (sign_ < 0 && rem != 0) {
+        rem = value - rem;
+    }
+    return BigInteger(1, ContainerType(1, rem, container_.resource()));
+}
+
+std::pair<BigInteger, BigInteger> BigInteger::DivMod(const BigInteger& other) const {
+    std::size_t num_size = NormalizedSize(container_);
+    std::size_t den_size = NormalizedSize(other.container_);
+    if (den_size == 0) {
         throw std::logic_error("div by zero");
     }
+    if (num_size < den_size) {
+        return {BigInteger(Resource()), BigInteger(*this, Resource())};
+    }
+
+    ContainerType quot(num_size - den_size + 1, 0, container_.resource());
+    ContainerType rem(den_size, 0, container_.resource());
+    limbs::DivRem(quot.data(), rem.data(), container_.data(), num_size, other.container_.data(),
+                  den_size, container_.resource());
+
+    std::pair<BigInteger, BigInteger> res(BigInteger(this->sign_ * other.sign_, std::move(quot)),
+                                          BigInteger(this->sign_, std::move(rem)));
+    res.first.Trim();
+    res.second.Trim();
+    return res;
+}
 
-    while (cur >= other) {
-        BigInteger mult = 1;
-        while (other * mult * kModule < cur) {
-            mult *= kModule;
+BigInteger BigInteger::Pow(const BigInteger& exponent) const {
+    if (exponent.sign_ < 0) {
+        throw std::invalid_argument("BigInteger: negative exponent");
+    }
+    std::size_t exp_size = NormalizedSize(exponent.container_);
+    std::size_t size = NormalizedSize(container_);
+    bool odd = exponent.container_[0] % 2 == 1;
+    if (exp_size == 0) {
+        return BigInteger(1, ContainerType(1, 1, Resource()));
+    }
+    // 0, 1 and -1 stay as they are for any exponent, but the sign of -1
+    if (size == 0 || (size == 1 && container_[0] == 1)) {
+        BigInteger res(*this, Resource());
+        res.sign_ = odd ? sign_ : 1;
+        return res;
+    }
+
+    CellType exp = exponent.container_[0];
+    std::size_t bits = limbs::BitLength(container_.data(), size);
+    if (exp_size > 1 || exp > std::numeric_limits<std::size_t>::max() / bits) {
+        throw std::length_error("BigInteger: power too large");
+    }
+
+    BigInteger magnitude(1, ContainerType(container_, Resource()));
+    magnitude.Trim();
+    BigInteger res(magnitude, Resource());
+    for (int bit = static_cast<int>(limbs::kCellBits) - __builtin_clzll(exp) - 2; bit >= 0;
+         --bit) {
+        res = res.Square();
+        if ((exp >> bit) & 1) {
+            res *= magnitude;
         }
+    }
+    res.sign_ = sign_ < 0 && odd ? -1 : 1;
+    return res;
+}
+
+BigInteger BigInteger::PowMod(const BigInteger& exponent, const BigInteger& modulus) const {
+    ModContext context(modulus);
+    return BigInteger(context.Leave(context.Pow(context.Enter(*this), exponent)), Resource());
+}
 
-        cur -= other * mult;
-        res += mult;
+BigInteger BigInteger::Sqrt() const {
+    if (sign_ < 0) {
+        throw std::invalid_argument("BigInteger: root of a negative number");
     }
+    std::size_t size = NormalizedSize(container_);
+    if (size == 0) {
+        return BigInteger(Resource());
+    }
+    // An even shift puts two top bits into the top cell and halves for the root
+    unsigned shift = __builtin_clzll(container_[size - 1]) & ~1u;
+    return SqrtRemNormalized(ShiftLeft(shift)).first.ShiftRight(shift / 2);
+}
 
-    res.sign_ = this->sign_ * other.sign_;
+std::pair<BigInteger, BigInteger> BigInteger::SqrtRem() const {
+    std::size_t size = NormalizedSize(container_);
+    if (sign_ > 0 && size > 0 && container_[size - 1] >> (limbs::kCellBits - 2) != 0) {
+        return SqrtRemNormalized(*this);
+    }
+    BigInteger root = Sqrt();
+    BigInteger rem = *this - root.Square();
+    return {std::move(root), std::move(rem)};
+}
+
+// Zimmermann's recursion: the root of the top half of the cells gives the top half of
+// the root, and dividing the remainder by twice that root gives the bottom half up to
+// a correction by one. A quarter of the cells is split off, the top half keeps at
+// least as many, so its root has the precision the division needs
+std::pair<BigInteger, BigInteger> BigInteger::SqrtRemNormalized(const BigInteger& value) {
+    std::size_t size = NormalizedSize(value.container_);
+    if (size <= 2) {
+        auto [root, rem] =
+            SqrtRemTwoCells(value.container_[0], size == 2 ? value.container_[1] : 0);
+        ContainerType rem_cells(2, 0, value.Resource());
+        rem_cells[0] = static_cast<CellType>(rem);
+        rem_cells[1] = static_cast<CellType>(rem >> limbs::kCellBits);
+        BigInteger rem_value(1, std::move(rem_cells));
+        rem_value.Trim();
+        return {BigInteger(1, ContainerType(1, root, value.Resource())), std::move(rem_value)};
+    }
+    std::size_t low = size / 4;
+    if (low == 0) {
+        // Three cells: with one more the root gains half a cell, shifted out at the end
+        BigInteger root = SqrtRemNormalized(value.ShiftLeft(limbs::kCellBits))
+                              .first.ShiftRight(limbs::kCellBits / 2);
+        BigInteger rem = value - root.Square();
+        return {std::move(root), std::move(rem)};
+    }
+
+    std::size_t low_bits = low * limbs::kCellBits;
+    auto [high_root, high_rem] = SqrtRemNormalized(value.CellRange(2 * low, size));
+    auto [quot, rem] = (high_rem.ShiftLeft(low_bits) + value.CellRange(low, 2 * low))
+                           .DivMod(high_root.ShiftLeft(1));
+    BigInteger root = high_root.ShiftLeft(low_bits) + quot;
+    rem = rem.ShiftLeft(low_bits) + value.CellRange(0, low) - quot.Square();
+    if (rem.sign_ < 0) {
+        rem += root.ShiftLeft(1) - 1;
+        root -= 1;
+    }
+    return {std::move(root), std::move(rem)};
+}
 
+BigInteger BigInteger::Root(const BigInteger& degree) const {
+    std::size_t degree_size = NormalizedSize(degree.container_);
+    if (degree.sign_ < 0 || degree_size == 0) {
+        throw std::invalid_argument("BigInteger: root of degree below 1");
+    }
+    if (sign_ < 0 && degree.container_[0] % 2 == 0) {
+        throw std::invalid_argument("BigInteger: even root of a negative number");
+    }
+    if (degree_size == 1 && degree.container_[0] == 1) {
+        return BigInteger(*this, Resource());
+    }
+    std::size_t bits = BitLength();
+    if (degree_size > 1 || degree.container_[0] >= bits) {
+        // |*this| < 2^degree, so the root is 0, 1 or -1
+        return BigInteger(sign_, ContainerType(1, bits == 0 ? 0 : 1, Resource()));
+    }
+
+    BigInteger magnitude(1, ContainerType(container_, Resource()));
+    magnitude.Trim();
+    BigInteger root =
+        degree.container_[0] == 2 ? magnitude.Sqrt() : RootFloor(magnitude, degree.container_[0]);
+    root.sign_ = sign_;
+    return root;
+}
+
+// Newton's iteration started above the root decreases until it reaches the floor of
+// the root. The root of the top bits is right in half of the bits, so a few steps are
+// enough, and the cost is dominated by the steps at full size
+BigInteger BigInteger::RootFloor(const BigInteger& value, std::uint64_t degree) {
+    std::size_t bits = value.BitLength();
+    std::size_t root_bits = (bits + degree - 1) / degree;
+    BigInteger root(value.Resource());
+    if (root_bits <= kRootBasecaseBits) {
+        // The top 64 bits give the logarithm to far more bits than the root has
+        std::size_t shift = bits > limbs::kCellBits ? bits - limbs::kCellBits : 0;
+        double log = std::log2(static_cast<double>(value.BitsAt(shift))) + shift;
+        root = BigInteger(static_cast<CellType>(std::exp2(log / degree)) + 1);
+    } else {
+        std::size_t half = root_bits / 2;
+        root = (RootFloor(value.ShiftRight(degree * half), degree) + 1).ShiftLeft(half);
+    }
+
+    BigInteger lower_degree = BigInteger(degree - 1);
+    while (true) {
+        BigInteger next = (root * lower_degree + value / root.Pow(lower_degree)) / degree;
+        if (next >= root) {
+            return root;
+        }
+        root = std::move(next);
+    }
+}
+
+BigInteger BigInteger::Gcd(const BigInteger& other) const {
+    BigInteger lhs(1, ContainerType(container_, Resource()));
+    BigInteger rhs(1, ContainerType(other.container_, Resource()));
+    lhs.Trim();
+    rhs.Trim();
+    return Lehmer(std::move(lhs), std::move(rhs), nullptr);
+}
+
+BigInteger BigInteger::Lcm(const BigInteger& other) const {
+    if (NormalizedSize(container_) == 0 || NormalizedSize(other.container_) == 0) {
+        return BigInteger(Resource());
+    }
+    BigInteger res = *this / Gcd(other) * other;
+    res.sign_ = 1;
     return res;
 }
 
-BigInteger BigInteger::operator%(const BigInteger& other) const {
-    if (other == BigInteger(0)) {
+std::tuple<BigInteger, BigInteger, BigInteger> BigInteger::ExtendedGcd(
+    const BigInteger& other) const {
+    BigInteger lhs(1, ContainerType(container_, Resource()));
+    BigInteger rhs(1, ContainerType(other.container_, Resource()));
+    lhs.Trim();
+    rhs.Trim();
+    BigInteger lhs_coef(Resource());
+    BigInteger gcd = Lehmer(lhs, rhs, &lhs_coef);
+
+    // gcd = lhs * x + rhs * y gives the other coefficient by an exact division
+    BigInteger rhs_coef(Resource());
+    if (NormalizedSize(rhs.container_) != 0) {
+        rhs_coef = (gcd - lhs * lhs_coef) / rhs;
+    }
+    if (sign_ < 0) {
+        lhs_coef.Negate();
+    }
+    if (other.sign_ < 0) {
+        rhs_coef.Negate();
+    }
+    return {std::move(gcd), std::move(lhs_coef), std::move(rhs_coef)};
+}
+
+BigInteger BigInteger::ModInverse(const BigInteger& modulus) const {
+    BigInteger mod(1, ContainerType(modulus.container_, Resource()));
+    mod.Trim();
+    if (NormalizedSize(mod.container_) == 0) {
         throw std::logic_error("div by zero");
     }
-    BigInteger result = *this - (*this / other) * other;
-    if (result < 0) {
-        result = result + other;
+    BigInteger coef(Resource());
+    if (!(Lehmer(*this % mod, mod, &coef) == 1)) {
+        throw std::invalid_argument("BigInteger: not invertible");
     }
+    return coef % mod;
+}
 
-    return result;
+BigInteger BigInteger::Lehmer(BigInteger lhs, BigInteger rhs, BigInteger* coefficient) {
+    // The coefficients of the original lhs in the current lhs and rhs
+    BigInteger lhs_coef(BigInteger(1), lhs.Resource());
+    BigInteger rhs_coef(lhs.Resource());
+    if (lhs < rhs) {
+        std::swap(lhs, rhs);
+        std::swap(lhs_coef, rhs_coef);
+    }
+
+    while (NormalizedSize(rhs.container_) != 0) {
+        if (!coefficient && NormalizedSize(lhs.container_) == 1) {
+            return BigInteger(1, ContainerType(1, std::gcd(lhs.container_[0], rhs.container_[0]),
+                                               lhs.Resource()));
+        }
+        std::size_t bits = lhs.BitLength();
+        std::size_t shift = bits > kLehmerBits ? bits - kLehmerBits : 0;
+        Cofactors cof = LehmerCofactors(lhs.BitsAt(shift), rhs.BitsAt(shift));
+        if (cof.b == 0) {
+            auto [quot, rem] = lhs.DivMod(rhs);
+            lhs = std::move(rhs);
+            rhs = std::move(rem);
+            if (coefficient) {
+                lhs_coef.SubMul(quot, rhs_coef);
+                std::swap(lhs_coef, rhs_coef);
+            }
+            continue;
+        }
+
+        BigInteger next_lhs = lhs * cof.a;
+        next_lhs.AddMul(rhs, cof.b);
+        rhs *= cof.d;
+        rhs.AddMul(lhs, cof.c);
+        lhs = std::move(next_lhs);
+        if (coefficient) {
+            BigInteger next_coef = lhs_coef * cof.a;
+            next_coef.AddMul(rhs_coef, cof.b);
+            rhs_coef *= cof.d;
+            rhs_coef.AddMul(lhs_coef, cof.c);
+            lhs_coef = std::move(next_coef);
+        }
+    }
+
+    if (coefficient) {
+        *coefficient = std::move(lhs_coef);
+    }
+    return lhs;
 }
 
 bool BigInteger::operator<(const BigInteger& other) const {
     bool sign_compare = sign_ == other.sign_;
     return !sign_compare && sign_ < other.sign_ ||
-           sign_compare && AbsoluteCompare<Less>(container_, other.container_) == sign_ > 0;
+           sign_compare && AbsoluteCompare(container_, other.container_) * sign_ < 0;
 }
 
 bool BigInteger::operator>(const BigInteger& other) const {
     bool sign_compare = sign_ == other.sign_;
     return !sign_compare && sign_ > other.sign_ ||
-           sign_compare && AbsoluteCompare<More>(container_, other.container_) == sign_ > 0;
+           sign_compare && AbsoluteCompare(container_, other.container_) * sign_ > 0;
 }
 
 bool BigInteger::operator<=(const BigInteger& other) const {
@@ -399,25 +810,110 @@ bool BigInteger::operator>=(const BigInteger& other) const {
     return this->operator>(other) || *this == (other);
 }
 
+int BigInteger::CompareCell(CellType value, std::int8_t sign) const {
+    if (sign_ != sign) {
+        return sign_ < sign ? -1 : 1;
+    }
+    std::size_t size = NormalizedSize(container_);
+    CellType cell = size == 0 ? 0 : container_[0];
+    int magnitude = size > 1 ? 1 : (cell > value) - (cell < value);
+    return magnitude * sign_;
+}
+
+std::size_t BigInteger::BitLength() const {
+    return limbs::BitLength(container_.data(), NormalizedSize(container_));
+}
+
+CellType BigInteger::BitsAt(std::size_t shift) const {
+    std::size_t size = NormalizedSize(container_);
+    std::size_t idx = shift / limbs::kCellBits;
+    unsigned offset = shift % limbs::kCellBits;
+    CellType res = idx < size ? container_[idx] >> offset : 0;
+    if (offset != 0 && idx + 1 < size) {
+        res |= container_[idx + 1] << (limbs::kCellBits - offset);
+    }
+    return res;
+}
+
+BigInteger BigInteger::ShiftLeft(std::size_t bits) const {
+    std::size_t size = NormalizedSize(container_);
+    std::size_t cells = bits / limbs::kCellBits;
+    unsigned offset = bits % limbs::kCellBits;
+    ContainerType res(size + cells + 1, 0, container_.resource());
+    if (offset == 0) {
+        std::copy(container_.begin(), container_.begin() + size, res.begin() + cells);
+    } else {
+        res[size + cells] =
+            limbs::ShiftLeft(res.data() + cells, container_.data(), size, offset);
+    }
+    BigInteger shifted(sign_, std::move(res));
+    shifted.Trim();
+    return shifted;
+}
+
+BigInteger BigInteger::ShiftRight(std::size_t bits) const {
+    std::size_t size = NormalizedSize(container_);
+    std::size_t cells = bits / limbs::kCellBits;
+    if (cells >= size) {
+        return BigInteger(Resource());
+    }
+    unsigned offset = bits % limbs::kCellBits;
+    ContainerType res(size - cells, 0, container_.resource());
+    if (offset == 0) {
+        std::copy(container_.begin() + cells, container_.begin() + size, res.begin());
+    } else {
+        limbs::ShiftRight(res.data(), container_.data() + cells, size - cells, offset);
+    }
+    BigInteger shifted(sign_, std::move(res));
+    shifted.Trim();
+    return shifted;
+}
+
+BigInteger BigInteger::CellRange(std::size_t begin, std::size_t end) const {
+    ContainerType res(std::max<std::size_t>(end - begin, 1), 0, container_.resource());
+    std::copy(container_.begin() + begin, container_.begin() + end, res.begin());
+    BigInteger range(1, std::move(res));
+    range.Trim();
+    return range;
+}
+
+std::pmr::memory_resource* BigInteger::Resource() const {
+    return container_.resource();
+}
+
+std::size_t BigInteger::Cells() const {
+    return std::max<std::size_t>(NormalizedSize(container_), 1);
+}
+
 std::string BigInteger::ToString() const {
-    std::ostringstream ostream;
+    std::string result(limbs::DecimalDigits(container_.data(), NormalizedSize(container_)) + 1,
+                       '\0');
+    auto [end, ec] = ToChars(result.data(), result.data() + result.size());
+    result.resize(end - result.data());
 
+    return result;
+}
+
+std::to_chars_result BigInteger::ToChars(char* first, char* last) const {
+    char* pos = first;
     if (sign_ == -1) {
-        ostream << "-";
-    }
-    for (auto item = container_.rbegin(); item != container_.rend(); ++item) {
-        if (item != container_.rbegin()) {
-            ostream << std::setw(kWidth) << std::setfill('0');
+        if (pos == last) {
+            return {last, std::errc::value_too_large};
         }
-        ostream << *item;
+        *pos++ = '-';
     }
 
-    return ostream.str();
+    pos = limbs::ToDecimal(pos, last, container_.data(), NormalizedSize(container_),
+                           container_.resource());
+    if (pos == nullptr) {
+        return {last, std::errc::value_too_large};
+    }
+    return {pos, std::errc()};
 }
 
 bool operator==(const BigInteger& lhs, const BigInteger& rhs) {
     bool sign_compare = lhs.sign_ == rhs.sign_;
-    return sign_compare && AbsoluteCompare<BigInteger::Eq>(lhs.container_, rhs.container_);
+    return sign_compare && AbsoluteCompare(lhs.container_, rhs.container_) == 0;
 }
 
 std::ostream& operator<<(std::ostream& stream, const big_numbers::BigInteger& num) {
@@ -1,19 +1,24 @@
 #pragma once
 
-#include <vector>
+#include <charconv>
 #include <cstdint>
-#include <functional>
+#include <utility>
+#include <istream>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 
-namespace big_numbers {
-
-namespace {
+#include "cell_vector.hpp"
+#include "limbs.hpp"
 
-static constexpr std::size_t CalcModule(std::size_t width) {
-    return width == 1 ? 10 : 10 * CalcModule(width - 1);
-}
+namespace big_numbers {
 
-}  // namespace
+class ModContext;
+template <std::size_t Bits>
+class FixedBigInteger;
 
 class BigInteger {
 private:
@@ -21,22 +26,33 @@ private:
     BigInteger(std::uint64_t);
 
 public:
-    // Now we can use kWidth more than 9, because we use Karatsuba algorithm in
-    // MultTwoCells
-    static constexpr std::size_t kWidth = 16;
-    static constexpr std::size_t kModule = CalcModule(kWidth);
-    static_assert(kWidth % 2 == 0, "kWidth must be even for Karatsuba algorithm");
-
-    using CellType = std::size_t;
-    using ContainerType = std::vector<CellType>;
+    // Magnitude is stored in base 2^64, least significant cell first. Decimal
+    // digits appear only in the decimal conversions below. Numbers up to
+    // CellVector::kInlineCapacity cells don't touch the heap
+    using CellType = limbs::CellType;
+    using ContainerType = CellVector;
 
     template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
-    BigInteger(T integer) : BigInteger(static_cast<std::int64_t>(integer)) {
+    BigInteger(T integer)
+        : BigInteger(
+              static_cast<std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>(
+                  integer)) {
     }
 
     BigInteger(const std::string_view&);
     BigInteger();
 
+    // Cells longer than the inline ones come from a std::pmr::memory_resource, by
+    // default std::pmr::get_default_resource(). Results of operations take the
+    // resource of the left operand, so the temporaries of a computation on numbers
+    // in an arena stay in the arena. Copies get the default resource unless another
+    // one is given, moves keep the resource of the source and assignments the one
+    // of the target, like std::pmr containers
+
+    /// Zero with its cells in resource
+    explicit BigInteger(std::pmr::memory_resource* resource);
+    BigInteger(const BigInteger&, std::pmr::memory_resource* resource);
+
     BigInteger(const BigInteger&);
     BigInteger(BigInteger&&);
 
@@ -44,19 +60,78 @@ public:
     BigInteger& operator=(BigInteger&&);
     BigInteger& operator=(std::int64_t);
 
+    // Compound operators work on the cells of *this, growing them at most once
     BigInteger& operator+=(const BigInteger&);
     BigInteger& operator-=(const BigInteger&);
     BigInteger& operator*=(const BigInteger&);
 
-    BigInteger operator+(const BigInteger&) const;
-    BigInteger operator-(const BigInteger&) const;
-    BigInteger operator-() const;
+    // Fused *this += lhs * rhs and *this -= lhs * rhs. The product is accumulated
+    // straight into *this without building a BigInteger for it
+    BigInteger& AddMul(const BigInteger& lhs, const BigInteger& rhs);
+    BigInteger& SubMul(const BigInteger& lhs, const BigInteger& rhs);
+
+    // Overloads taking temporaries reuse their cells for the result,
+    // so chains like a + b + c allocate only once
+    BigInteger operator+(const BigInteger&) const&;
+    BigInteger operator+(const BigInteger&) &&;
+    BigInteger operator+(BigInteger&&) const&;
+    BigInteger operator+(BigInteger&&) &&;
+    BigInteger operator-(const BigInteger&) const&;
+    BigInteger operator-(const BigInteger&) &&;
+    BigInteger operator-(BigInteger&&) const&;
+    BigInteger operator-(BigInteger&&) &&;
+    BigInteger operator-() const&;
+    BigInteger operator-() &&;
     BigInteger operator+() const;
 
-    BigInteger operator*(const BigInteger&) const;
+    // Equal operands, the same object or equal cells, are squared
+    BigInteger operator*(const BigInteger&) const&;
+    BigInteger operator*(const BigInteger&) &&;
+    /// *this * *this by the squaring kernels, which need about half the cell products
+    /// of a general product
+    BigInteger Square() const;
+    // Quotient is truncated toward zero, remainder of % is never negative
     BigInteger operator/(const BigInteger&) const;
     BigInteger operator%(const BigInteger&) const;
 
+    // Quotient and remainder in one division: *this = quotient * other + remainder,
+    // quotient is truncated toward zero and remainder has the sign of *this
+    std::pair<BigInteger, BigInteger> DivMod(const BigInteger&) const;
+
+    /// *this raised to exponent >= 0, 0^0 is 1. Left to right binary powering, the
+    /// squarings go through the squaring kernels
+    BigInteger Pow(const BigInteger& exponent) const;
+    /// *this raised to exponent >= 0 modulo modulus, never negative like %. Goes
+    /// through a ModContext, keep one for many powers by the same modulus
+    BigInteger PowMod(const BigInteger& exponent, const BigInteger& modulus) const;
+
+    /// Square root rounded down by Zimmermann's Karatsuba square root, which costs
+    /// about as much as dividing the number by one of half its size. Throws
+    /// std::invalid_argument for negative numbers
+    BigInteger Sqrt() const;
+    /// Sqrt() and the remainder *this - Sqrt()^2
+    std::pair<BigInteger, BigInteger> SqrtRem() const;
+    /// degree-th root truncated toward zero, degree >= 1. Newton's iteration starts
+    /// from the root of the top bits, so only its last steps run at full size. Throws
+    /// std::invalid_argument for an even root of a negative number
+    BigInteger Root(const BigInteger& degree) const;
+
+    // Lehmer's algorithm: runs of quotients of Euclid's algorithm are found from the
+    // top bits of the numbers alone and applied to the full numbers at once, by a
+    // matrix of single cell cofactors. A division is left only for the quotients the
+    // top bits don't determine
+
+    /// Greatest common divisor, never negative, Gcd(0, 0) is 0
+    BigInteger Gcd(const BigInteger&) const;
+    /// Least common multiple, never negative, 0 when a number is 0
+    BigInteger Lcm(const BigInteger&) const;
+    /// {g, x, y} with g = Gcd(other) and *this * x + other * y = g, x and y are the
+    /// coefficients Euclid's algorithm gives
+    std::tuple<BigInteger, BigInteger, BigInteger> ExtendedGcd(const BigInteger& other) const;
+    /// x in [0, |modulus|) with *this * x = 1 modulo modulus. Throws std::logic_error
+    /// for a zero modulus and std::invalid_argument when *this isn't coprime to it
+    BigInteger ModInverse(const BigInteger& modulus) const;
+
     bool operator<(const BigInteger&) const;
     bool operator>(const BigInteger&) const;
 
@@ -67,19 +142,168 @@ public:
     // have same namespace as BigInteger and be picked up by ADL
     friend bool operator==(const BigInteger&, const BigInteger&);
 
+    // Integral operands are taken as a cell and a sign, so they go straight to the one
+    // cell kernels without a BigInteger built for them. Results are the same as with
+    // the operand converted to a BigInteger
+
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger& operator+=(T value) {
+        return AddCell(CellOf(value), SignOf(value));
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger& operator-=(T value) {
+        return AddCell(CellOf(value), static_cast<std::int8_t>(-SignOf(value)));
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger& operator*=(T value) {
+        return MulCell(CellOf(value), SignOf(value));
+    }
+
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator+(T value) const& {
+        BigInteger res = CopyWithCapacity(container_.size() + 1);
+        res += value;
+        return res;
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator+(T value) && {
+        *this += value;
+        return std::move(*this);
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator-(T value) const& {
+        BigInteger res = CopyWithCapacity(container_.size() + 1);
+        res -= value;
+        return res;
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator-(T value) && {
+        *this -= value;
+        return std::move(*this);
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator*(T value) const& {
+        BigInteger res = CopyWithCapacity(container_.size() + 1);
+        res *= value;
+        return res;
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator*(T value) && {
+        *this *= value;
+        return std::move(*this);
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator/(T value) const {
+        return DivCell(CellOf(value), SignOf(value));
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    BigInteger operator%(T value) const {
+        return ModCell(CellOf(value));
+    }
+
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    bool operator<(T value) const {
+        return CompareCell(CellOf(value), SignOf(value)) < 0;
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    bool operator>(T value) const {
+        return CompareCell(CellOf(value), SignOf(value)) > 0;
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    bool operator<=(T value) const {
+        return CompareCell(CellOf(value), SignOf(value)) <= 0;
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    bool operator>=(T value) const {
+        return CompareCell(CellOf(value), SignOf(value)) >= 0;
+    }
+
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    friend bool operator==(const BigInteger& lhs, T rhs) {
+        return lhs.CompareCell(CellOf(rhs), SignOf(rhs)) == 0;
+    }
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    friend bool operator==(T lhs, const BigInteger& rhs) {
+        return rhs.CompareCell(CellOf(lhs), SignOf(lhs)) == 0;
+    }
+
     std::string ToString() const;
 
+    /// Cells of the magnitude without leading zeros, zero takes one
+    std::size_t Cells() const;
+    std::pmr::memory_resource* Resource() const;
+
+    /// Writes the decimal representation to [first, last) like std::to_chars: on
+    /// success ptr is one past the last written character, otherwise ec is
+    /// std::errc::value_too_large and ptr == last
+    std::to_chars_result ToChars(char* first, char* last) const;
+    /// Reads an optional '-' followed by decimal digits from [first, last) like
+    /// std::from_chars, stopping at the first non-digit. Without digits ec is
+    /// std::errc::invalid_argument, ptr == first and *this is left unchanged
+    std::from_chars_result FromChars(const char* first, const char* last);
+
 private:
-    using Less = std::less<CellType>;
-    using More = std::greater<CellType>;
-    using Eq = std::equal_to<CellType>;
+    friend class ModContext;
+    template <std::size_t Bits>
+    friend class FixedBigInteger;
 
     BigInteger(std::int8_t, ContainerType&&);
 
     std::int8_t sign_;
-    std::vector<CellType> container_;
+    ContainerType container_;
 
     BigInteger& FixSign();
+    BigInteger& Trim();
+    BigInteger& Negate();
+
+    BigInteger CopyWithCapacity(std::size_t) const;
+
+    /// Magnitude of an integral value, the minimum of a signed type included
+    template <typename T>
+    static constexpr CellType CellOf(T value) {
+        if constexpr (std::is_signed_v<T>) {
+            if (value < 0) {
+                return CellType{0} - static_cast<CellType>(value);
+            }
+        }
+        return static_cast<CellType>(value);
+    }
+    template <typename T>
+    static constexpr std::int8_t SignOf(T value) {
+        if constexpr (std::is_signed_v<T>) {
+            return value < 0 ? -1 : 1;
+        }
+        return 1;
+    }
+
+    // The integral operators on a magnitude of one cell and its sign, zero has sign 1
+    BigInteger& AddCell(CellType value, std::int8_t sign);
+    BigInteger& MulCell(CellType value, std::int8_t sign);
+    BigInteger DivCell(CellType value, std::int8_t sign) const;
+    BigInteger ModCell(CellType value) const;
+    /// -1, 0 or 1 as *this is below, equal to or above the value
+    int CompareCell(CellType value, std::int8_t sign) const;
+    BigInteger& AddSigned(const BigInteger&, std::int8_t);
+    BigInteger& MulAccumulate(const BigInteger&, const BigInteger&, std::int8_t);
+    /// Square with the given sign, for the product of equal magnitudes
+    BigInteger SquareWithSign(std::int8_t) const;
+
+    std::size_t BitLength() const;
+    /// 64 bits of the magnitude starting at bit shift
+    CellType BitsAt(std::size_t shift) const;
+    // Magnitude times or divided by 2^bits, the sign is kept
+    BigInteger ShiftLeft(std::size_t bits) const;
+    BigInteger ShiftRight(std::size_t bits) const;
+    /// Cells [begin, end) of the magnitude as a number
+    BigInteger CellRange(std::size_t begin, std::size_t end) const;
+
+    /// Square root and remainder of value > 0 whose top cell is at least 2^62
+    static std::pair<BigInteger, BigInteger> SqrtRemNormalized(const BigInteger& value);
+    /// degree-th root rounded down of value > 0, 2 <= degree < value.BitLength()
+    static BigInteger RootFloor(const BigInteger& value, std::uint64_t degree);
+    /// Gcd of lhs, rhs >= 0. With coefficient it also gives x with lhs * x = Gcd
+    /// modulo rhs, the coefficient of lhs in the extended algorithm
+    static BigInteger Lehmer(BigInteger lhs, BigInteger rhs, BigInteger* coefficient);
 
     void ConstuctFromString(const std::string_view&);
 };
@@ -0,0 +1,103 @@
+#include "cell_vector.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace big_numbers {
+
+CellVector::CellVector() : CellVector(std::pmr::get_default_resource()) {
+}
+
+CellVector::CellVector(std::pmr::memory_resource* resource) : resource_(resource), data_(inline_) {
+}
+
+CellVector::CellVector(std::size_t size, CellType value, std::pmr::memory_resource* resource)
+    : CellVector(resource) {
+    assign(size, value);
+}
+
+CellVector::CellVector(const CellVector& other)
+    : CellVector(other, std::pmr::get_default_resource()) {
+}
+
+CellVector::CellVector(const CellVector& other, std::pmr::memory_resource* resource)
+    : CellVector(resource) {
+    reserve(other.size_);
+    std::copy(other.begin(), other.end(), data_);
+    size_ = other.size_;
+}
+
+CellVector::CellVector(CellVector&& other) : CellVector(other.resource_) {
+    *this = std::move(other);
+}
+
+CellVector& CellVector::operator=(const CellVector& other) {
+    if (this != &other) {
+        reserve(other.size_);
+        std::copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+    return *this;
+}
+
+CellVector& CellVector::operator=(CellVector&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (other.IsInline() || *resource_ != *other.resource_) {
+        // Cells of another resource can't be freed by ours, they are copied
+        reserve(other.size_);
+        std::copy(other.begin(), other.end(), data_);
+    } else {
+        Release();
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        other.data_ = other.inline_;
+        other.capacity_ = kInlineCapacity;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+}
+
+CellVector::~CellVector() {
+    Release();
+}
+
+void CellVector::Release() {
+    if (!IsInline()) {
+        resource_->deallocate(data_, capacity_ * sizeof(CellType), alignof(CellType));
+        data_ = inline_;
+        capacity_ = kInlineCapacity;
+    }
+}
+
+void CellVector::reserve(std::size_t capacity) {
+    if (capacity <= capacity_) {
+        return;
+    }
+    auto data = static_cast<CellType*>(
+        resource_->allocate(capacity * sizeof(CellType), alignof(CellType)));
+    std::copy(begin(), end(), data);
+    Release();
+    data_ = data;
+    capacity_ = capacity;
+}
+
+void CellVector::resize(std::size_t size, CellType value) {
+    if (size > size_) {
+        if (size > capacity_) {
+            reserve(std::max(size, 2 * capacity_));
+        }
+        std::fill(data_ + size_, data_ + size, value);
+    }
+    size_ = size;
+}
+
+void CellVector::assign(std::size_t size, CellType value) {
+    reserve(size);
+    std::fill(data_, data_ + size, value);
+    size_ = size;
+}
+
+}  // namespace big_numbers
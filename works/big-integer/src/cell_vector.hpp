@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "limbs.hpp"
+
+namespace big_numbers {
+
+/// Growable array of cells that keeps up to kInlineCapacity cells inside the
+/// object and takes longer ones from a std::pmr::memory_resource. Mirrors the part
+/// of the std::pmr::vector interface BigInteger needs, with the same rules for the
+/// resource: a copy gets the default resource unless one is given, a move takes the
+/// resource along and assignments keep the resource of the target
+class CellVector {
+public:
+    using CellType = limbs::CellType;
+    using iterator = CellType*;
+    using const_iterator = const CellType*;
+
+    static constexpr std::size_t kInlineCapacity = 2;
+
+    CellVector();
+    explicit CellVector(std::pmr::memory_resource*);
+    explicit CellVector(std::size_t size, CellType value = 0,
+                        std::pmr::memory_resource* = std::pmr::get_default_resource());
+
+    CellVector(const CellVector&);
+    CellVector(const CellVector&, std::pmr::memory_resource*);
+    CellVector(CellVector&&);
+
+    CellVector& operator=(const CellVector&);
+    CellVector& operator=(CellVector&&);
+
+    ~CellVector();
+
+    std::size_t size() const {
+        return size_;
+    }
+    std::size_t capacity() const {
+        return capacity_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    std::pmr::memory_resource* resource() const {
+        return resource_;
+    }
+
+    CellType* data() {
+        return data_;
+    }
+    const CellType* data() const {
+        return data_;
+    }
+
+    CellType& operator[](std::size_t idx) {
+        return data_[idx];
+    }
+    const CellType& operator[](std::size_t idx) const {
+        return data_[idx];
+    }
+
+    CellType& back() {
+        return data_[size_ - 1];
+    }
+    const CellType& back() const {
+        return data_[size_ - 1];
+    }
+
+    iterator begin() {
+        return data_;
+    }
+    iterator end() {
+        return data_ + size_;
+    }
+    const_iterator begin() const {
+        return data_;
+    }
+    const_iterator end() const {
+        return data_ + size_;
+    }
+
+    void reserve(std::size_t capacity);
+    void resize(std::size_t size, CellType value = 0);
+    void assign(std::size_t size, CellType value);
+    void clear() {
+        size_ = 0;
+    }
+
+    void push_back(CellType value) {
+        if (size_ == capacity_) {
+            reserve(2 * capacity_);
+        }
+        data_[size_++] = value;
+    }
+    void pop_back() {
+        --size_;
+    }
+
+    /// True while the cells live inside the object
+    bool IsInline() const {
+        return data_ == inline_;
+    }
+
+private:
+    void Release();
+
+    std::pmr::memory_resource* resource_;
+    CellType* data_;
+    std::size_t size_{0};
+    std::size_t capacity_{kInlineCapacity};
+    CellType inline_[kInlineCapacity];
+};
+
+}  // namespace big_numbers
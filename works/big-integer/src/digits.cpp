@@ -0,0 +1,130 @@
+#include "digits.hpp"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace big_numbers::limbs {
+
+namespace {
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+const char* ScanScalar(const char* first, const char* last) {
+    while (first != last && IsDigit(*first)) {
+        ++first;
+    }
+    return first;
+}
+
+// Eight digits in one cell, the first digit in the lowest byte (little endian).
+// Neighbouring digits are merged into pairs, pairs into quads and quads into the
+// result by multiplications that keep every partial sum in its own bit field
+CellType ParseEight(const char* digits) {
+    CellType value;
+    std::memcpy(&value, digits, sizeof(value));
+    value -= 0x3030303030303030ull;
+    value = value * 10 + (value >> 8);
+    return (((value & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+            (((value >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >>
+           32;
+}
+
+#ifdef __SSE2__
+
+// Bit i of the result is set when chars[i] is a digit
+int DigitMask(__m128i chars) {
+    __m128i above = _mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1));
+    __m128i below = _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1));
+    return _mm_movemask_epi8(_mm_and_si128(above, below));
+}
+
+const char* ScanSse2(const char* first, const char* last) {
+    for (; last - first >= 16; first += 16) {
+        int mask = ~DigitMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))) & 0xFFFF;
+        if (mask != 0) {
+            return first + __builtin_ctz(mask);
+        }
+    }
+    return ScanScalar(first, last);
+}
+
+__attribute__((target("avx2"))) const char* ScanAvx2(const char* first, const char* last) {
+    const __m256i low = _mm256_set1_epi8('0' - 1);
+    const __m256i high = _mm256_set1_epi8('9' + 1);
+    for (; last - first >= 32; first += 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        __m256i digits =
+            _mm256_and_si256(_mm256_cmpgt_epi8(chars, low), _mm256_cmpgt_epi8(high, chars));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(digits));
+        if (mask != 0) {
+            return first + __builtin_ctz(mask);
+        }
+    }
+    return ScanSse2(first, last);
+}
+
+// SSE2 is enabled at compile time (always on x86-64), so no runtime check here
+CellType ParseSixteen(const char* digits) {
+    __m128i values = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)),
+                                  _mm_set1_epi8('0'));
+    // The leading digit of every pair sits in the low byte of a 16-bit lane
+    __m128i leading = _mm_and_si128(values, _mm_set1_epi16(0x00FF));
+    __m128i trailing = _mm_srli_epi16(values, 8);
+    __m128i pairs = _mm_add_epi16(_mm_mullo_epi16(leading, _mm_set1_epi16(10)), trailing);
+    // pair * 100 + next pair, then quad * 10^4 + next quad
+    __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x0001'0064));
+    __m128i eights = _mm_madd_epi16(_mm_packs_epi32(quads, quads), _mm_set1_epi32(0x0001'2710));
+
+    CellType high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(eights));
+    CellType low = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(eights, 4)));
+    return high * 100'000'000 + low;
+}
+
+#endif
+
+using ScanFunction = const char* (*)(const char*, const char*);
+
+ScanFunction PickScan() {
+#ifdef __SSE2__
+    if (__builtin_cpu_supports("avx2")) {
+        return ScanAvx2;
+    }
+    return ScanSse2;
+#else
+    return ScanScalar;
+#endif
+}
+
+}  // namespace
+
+const char* ScanDigits(const char* first, const char* last) {
+    static const ScanFunction scan = PickScan();
+    return scan(first, last);
+}
+
+CellType ParseDigits(const char* digits, std::size_t count) {
+    CellType value = 0;
+    std::size_t idx = 0;
+#ifdef __SSE2__
+    if (count >= 16) {
+        value = ParseSixteen(digits);
+        idx = 16;
+    }
+#endif
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; count - idx >= 8; idx += 8) {
+        value = value * 100'000'000 + ParseEight(digits + idx);
+    }
+#endif
+    for (; idx < count; ++idx) {
+        value = value * 10 + static_cast<CellType>(digits[idx] - '0');
+    }
+    return value;
+}
+
+}  // namespace big_numbers::limbs
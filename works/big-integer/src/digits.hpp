@@ -0,0 +1,17 @@
+#pragma once
+
+#include "limbs.hpp"
+
+// Scanning and converting runs of ASCII decimal digits. On x86 the work is done
+// 16 or 32 bytes at a time with SSE2 or AVX2, the AVX2 path is picked at runtime
+// when the CPU has it. Other targets use portable fallbacks.
+namespace big_numbers::limbs {
+
+/// End of the run of '0'..'9' that starts at first
+const char* ScanDigits(const char* first, const char* last);
+
+/// Value of count <= 19 decimal digits, all of them '0'..'9'.
+/// Sixteen and eight digits at a time are converted without a loop
+CellType ParseDigits(const char* digits, std::size_t count);
+
+}  // namespace big_numbers::limbs
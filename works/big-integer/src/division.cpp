@@ -0,0 +1,183 @@
+#include "division.hpp"
+#include "multiplication.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace big_numbers::limbs {
+
+namespace {
+
+using Cells = std::pmr::vector<CellType>;
+using Resource = std::pmr::memory_resource*;
+
+// Knuth's algorithm D. den is normalized (top bit set), den_size >= 2, and the top
+// den_size cells of num are less than den. The quotient (num_size - den_size cells)
+// goes to quot, the remainder replaces the low den_size cells of num
+void DivBasecase(CellType* quot, CellType* num, std::size_t num_size, const CellType* den,
+                 std::size_t den_size) {
+    const CellType den_high = den[den_size - 1];
+    const CellType den_low = den[den_size - 2];
+
+    for (std::size_t j = num_size - den_size; j-- > 0;) {
+        CellType* cur = num + j;
+        CellType num_high = cur[den_size];
+        CellType num_mid = cur[den_size - 1];
+        CellType num_low = cur[den_size - 2];
+
+        // Estimate the quotient cell from the top cells, it may be at most two too big
+        CellType estimate = ~CellType{0};
+        if (num_high < den_high) {
+            DoubleCellType top = (static_cast<DoubleCellType>(num_high) << kCellBits) | num_mid;
+            estimate = static_cast<CellType>(top / den_high);
+            CellType rest = static_cast<CellType>(top % den_high);
+            while (static_cast<DoubleCellType>(estimate) * den_low >
+                   ((static_cast<DoubleCellType>(rest) << kCellBits) | num_low)) {
+                --estimate;
+                rest += den_high;
+                if (rest < den_high) {
+                    break;
+                }
+            }
+        }
+
+        CellType top = num_high - SubMulOne(cur, den, den_size, estimate);
+        while (top != 0) {
+            --estimate;
+            top += AddN(cur, cur, den, den_size);
+        }
+        cur[den_size] = 0;
+        quot[j] = estimate;
+    }
+}
+
+void DivTwoByOne(CellType* quot, CellType* num, const CellType* den, std::size_t size,
+                 Resource resource);
+
+// a has 3 * half cells, den has 2 * half cells and the top 2 * half cells of a
+// are less than den. The quotient (half cells) goes to quot, the remainder replaces
+// the low 2 * half cells of a
+void DivThreeByTwo(CellType* quot, CellType* a, const CellType* den, std::size_t half,
+                   Resource resource) {
+    const CellType* den_low = den;
+    const CellType* den_high = den + half;
+
+    // Quotient estimate from the top two thirds of a and the high half of den
+    CellType top = 0;
+    if (CompareN(a + 2 * half, den_high, half) < 0) {
+        DivTwoByOne(quot, a + half, den_high, half, resource);
+    } else {
+        // The top halves are equal: the estimate is B^half - 1 and the remainder is
+        // a_high * B^half + a_mid - (B^half - 1) * den_high = a_mid + den_high
+        std::fill(quot, quot + half, ~CellType{0});
+        top = AddN(a + half, a + half, den_high, half);
+    }
+
+    Cells correction(2 * half, resource);
+    Mul(correction.data(), quot, half, den_low, half, resource);
+    top -= SubN(a, a, correction.data(), 2 * half);
+
+    // The estimate is at most two too big
+    while (top != 0) {
+        top += AddN(a, a, den, 2 * half);
+        SubOne(quot, quot, half, 1);
+    }
+}
+
+// num has 2 * size cells, den is normalized and the top size cells of num are less
+// than den. The quotient (size cells) goes to quot, the remainder replaces the low
+// size cells of num
+void DivTwoByOne(CellType* quot, CellType* num, const CellType* den, std::size_t size,
+                 Resource resource) {
+    // Halves of at least two cells, the basecase needs them
+    if (size % 2 == 1 || size < 4 || size < GetDivThresholds().burnikel_ziegler) {
+        DivBasecase(quot, num, 2 * size, den, size);
+        return;
+    }
+
+    std::size_t half = size / 2;
+    DivThreeByTwo(quot + half, num + half, den, half, resource);
+    DivThreeByTwo(quot, num, den, half, resource);
+}
+
+// res = src << shift, shift < kCellBits. res has size + 1 cells
+void ShiftInto(CellType* res, const CellType* src, std::size_t size, unsigned shift) {
+    if (shift == 0) {
+        std::copy(src, src + size, res);
+        res[size] = 0;
+    } else {
+        res[size] = ShiftLeft(res, src, size, shift);
+    }
+}
+
+// Burnikel-Ziegler: the divisor is padded to a block size that halves down to the
+// basecase, then the dividend is divided block by block with DivTwoByOne
+void DivLarge(CellType* quot, CellType* rem, const CellType* num, std::size_t num_size,
+              const CellType* den, std::size_t den_size, Resource resource) {
+    std::size_t threshold = GetDivThresholds().burnikel_ziegler;
+    std::size_t levels = 0;
+    while ((den_size >> levels) >= threshold) {
+        ++levels;
+    }
+    std::size_t block = ((den_size + (1ull << levels) - 1) >> levels) << levels;
+    std::size_t pad = block - den_size;
+    unsigned shift = __builtin_clzll(den[den_size - 1]);
+
+    Cells divisor(block + 1, 0, resource);
+    ShiftInto(divisor.data() + pad, den, den_size, shift);
+
+    // At least one free cell on top, so that the top block is less than the divisor
+    std::size_t blocks = (num_size + pad + 1 + block) / block;
+    Cells dividend(blocks * block, 0, resource);
+    ShiftInto(dividend.data() + pad, num, num_size, shift);
+
+    Cells quotient(blocks * block, 0, resource);
+    for (std::size_t idx = blocks - 1; idx-- > 0;) {
+        DivTwoByOne(quotient.data() + idx * block, dividend.data() + idx * block,
+                    divisor.data(), block, resource);
+    }
+
+    std::copy(quotient.begin(), quotient.begin() + (num_size - den_size + 1), quot);
+    if (shift == 0) {
+        std::copy(dividend.begin() + pad, dividend.begin() + block, rem);
+    } else {
+        ShiftRight(rem, dividend.data() + pad, den_size, shift);
+    }
+}
+
+}  // namespace
+
+DivThresholds& GetDivThresholds() {
+    static DivThresholds thresholds;
+    return thresholds;
+}
+
+void DivRem(CellType* quot, CellType* rem, const CellType* num, std::size_t num_size,
+            const CellType* den, std::size_t den_size, std::pmr::memory_resource* resource) {
+    if (den_size == 1) {
+        rem[0] = DivRemOne(quot, num, num_size, den[0]);
+        return;
+    }
+
+    std::size_t threshold = GetDivThresholds().burnikel_ziegler;
+    if (den_size >= threshold && num_size - den_size >= threshold) {
+        DivLarge(quot, rem, num, num_size, den, den_size, resource);
+        return;
+    }
+
+    unsigned shift = __builtin_clzll(den[den_size - 1]);
+    Cells divisor(den_size + 1, resource);
+    ShiftInto(divisor.data(), den, den_size, shift);
+    Cells dividend(num_size + 1, resource);
+    ShiftInto(dividend.data(), num, num_size, shift);
+
+    DivBasecase(quot, dividend.data(), num_size + 1, divisor.data(), den_size);
+
+    if (shift == 0) {
+        std::copy(dividend.begin(), dividend.begin() + den_size, rem);
+    } else {
+        ShiftRight(rem, dividend.data(), den_size, shift);
+    }
+}
+
+}  // namespace big_numbers::limbs
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "limbs.hpp"
+
+#include <memory_resource>
+
+namespace big_numbers::limbs {
+
+/// Divisor size (in cells) from which DivRem switches from Knuth's algorithm D
+/// to Burnikel-Ziegler recursive division
+struct DivThresholds {
+    std::size_t burnikel_ziegler = 60;
+};
+
+DivThresholds& GetDivThresholds();
+
+/// quot = num / den, rem = num % den. den_size > 0 and den[den_size - 1] != 0,
+/// num_size >= den_size. quot has num_size - den_size + 1 cells, rem has den_size
+/// cells, neither overlaps the operands. Temporaries come from resource
+void DivRem(CellType* quot, CellType* rem, const CellType* num, std::size_t num_size,
+            const CellType* den, std::size_t den_size, std::pmr::memory_resource* resource);
+
+}  // namespace big_numbers::limbs
@@ -0,0 +1,455 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "big_integer.hpp"
+#include "cell_vector.hpp"
+#include "limbs.hpp"
+
+namespace big_numbers {
+
+/// Signed integer of Bits bits in two's complement, Bits a multiple of 64. The cells
+/// live in a std::array, so values never touch the heap, and all the arithmetic is
+/// constexpr over a constant number of cells, which the compiler unrolls. A result
+/// outside [-2^(Bits - 1), 2^(Bits - 1)) throws std::overflow_error, so an overflow
+/// in a constant expression doesn't compile. / and % round like those of BigInteger
+template <std::size_t Bits>
+class FixedBigInteger {
+    static_assert(Bits > 0 && Bits % limbs::kCellBits == 0,
+                  "FixedBigInteger: Bits must be a positive multiple of 64");
+
+public:
+    using CellType = limbs::CellType;
+    using DoubleCellType = limbs::DoubleCellType;
+
+    static constexpr std::size_t kCells = Bits / limbs::kCellBits;
+
+    /// Least significant cell first
+    using ContainerType = std::array<CellType, kCells>;
+
+    constexpr FixedBigInteger() = default;
+
+    template <typename T, class = typename std::enable_if<std::is_integral_v<T>>::type>
+    constexpr FixedBigInteger(T integer) {
+        bool negative = false;
+        if constexpr (std::is_signed_v<T>) {
+            negative = integer < 0;
+        }
+        cells_[0] = static_cast<CellType>(integer);
+        for (std::size_t idx = 1; idx < kCells; ++idx) {
+            cells_[idx] = negative ? ~CellType{0} : 0;
+        }
+        // Only an unsigned 64 bit value with the top bit set doesn't fit 64 bits
+        CheckOverflow(IsNegative() != negative);
+    }
+
+    /// An optional '-' followed by decimal digits, constexpr unlike BigInteger's
+    constexpr explicit FixedBigInteger(std::string_view decimal) {
+        bool negative = !decimal.empty() && decimal[0] == '-';
+        if (decimal.size() == (negative ? 1 : 0)) {
+            throw std::invalid_argument("FixedBigInteger: empty number");
+        }
+        // Negative numbers are accumulated below zero, so the minimum is read too
+        for (std::size_t idx = negative ? 1 : 0; idx < decimal.size(); ++idx) {
+            if (decimal[idx] < '0' || decimal[idx] > '9') {
+                throw std::invalid_argument("FixedBigInteger: unexpected character in number");
+            }
+            int digit = decimal[idx] - '0';
+            *this = *this * 10 + (negative ? -digit : digit);
+        }
+    }
+
+    /// Throws std::overflow_error when value doesn't fit
+    explicit FixedBigInteger(const BigInteger& value) {
+        const CellVector& cells = value.container_;
+        std::size_t size = limbs::Normalize(cells.data(), cells.size());
+        CheckOverflow(size > kCells);
+        for (std::size_t idx = 0; idx < size; ++idx) {
+            cells_[idx] = cells[idx];
+        }
+        bool negative = value.sign_ < 0;
+        CheckOverflow(!FitsSigned(cells_, negative));
+        if (negative) {
+            cells_ = Negated(cells_);
+        }
+    }
+
+    explicit operator BigInteger() const {
+        bool negative = IsNegative();
+        ContainerType magnitude = Magnitude();
+        CellVector cells(kCells);
+        for (std::size_t idx = 0; idx < kCells; ++idx) {
+            cells[idx] = magnitude[idx];
+        }
+        BigInteger res(negative ? -1 : 1, std::move(cells));
+        res.Trim();
+        return res;
+    }
+
+    static constexpr FixedBigInteger Max() {
+        FixedBigInteger res;
+        for (std::size_t idx = 0; idx < kCells; ++idx) {
+            res.cells_[idx] = ~CellType{0};
+        }
+        res.cells_[kCells - 1] >>= 1;
+        return res;
+    }
+
+    static constexpr FixedBigInteger Min() {
+        FixedBigInteger res;
+        res.cells_[kCells - 1] = kTopBit;
+        return res;
+    }
+
+    constexpr const ContainerType& Cells() const {
+        return cells_;
+    }
+
+    constexpr bool IsNegative() const {
+        return (cells_[kCells - 1] & kTopBit) != 0;
+    }
+
+    friend constexpr FixedBigInteger operator+(const FixedBigInteger& lhs,
+                                               const FixedBigInteger& rhs) {
+        FixedBigInteger res;
+        CellType carry = 0;
+        for (std::size_t idx = 0; idx < kCells; ++idx) {
+            res.cells_[idx] = AddCells(lhs.cells_[idx], rhs.cells_[idx], carry);
+        }
+        // Only operands of one sign overflow, into the other sign
+        CheckOverflow(lhs.IsNegative() == rhs.IsNegative() &&
+                      res.IsNegative() != lhs.IsNegative());
+        return res;
+    }
+
+    friend constexpr FixedBigInteger operator-(const FixedBigInteger& lhs,
+                                               const FixedBigInteger& rhs) {
+        // lhs + ~rhs + 1
+        FixedBigInteger res;
+        CellType carry = 1;
+        for (std::size_t idx = 0; idx < kCells; ++idx) {
+            res.cells_[idx] = AddCells(lhs.cells_[idx], ~rhs.cells_[idx], carry);
+        }
+        CheckOverflow(lhs.IsNegative() != rhs.IsNegative() &&
+                      res.IsNegative() != lhs.IsNegative());
+        return res;
+    }
+
+    constexpr FixedBigInteger operator-() const {
+        FixedBigInteger res;
+        res.cells_ = Negated(cells_);
+        // The minimum is the only negative number equal to its negation
+        CheckOverflow(IsNegative() && res.IsNegative());
+        return res;
+    }
+
+    friend constexpr FixedBigInteger operator*(const FixedBigInteger& lhs,
+                                               const FixedBigInteger& rhs) {
+        ContainerType lhs_abs = lhs.Magnitude();
+        ContainerType rhs_abs = rhs.Magnitude();
+
+        // Schoolbook product of the magnitudes truncated to the width. Any dropped
+        // cross product or carry out of the top cell is an overflow
+        ContainerType product{};
+        bool overflow = false;
+        for (std::size_t i = 0; i < kCells; ++i) {
+            CellType carry = 0;
+            for (std::size_t j = 0; i + j < kCells; ++j) {
+                DoubleCellType cur = static_cast<DoubleCellType>(lhs_abs[i]) * rhs_abs[j] +
+                                     product[i + j] + carry;
+                product[i + j] = static_cast<CellType>(cur);
+                carry = static_cast<CellType>(cur >> limbs::kCellBits);
+            }
+            for (std::size_t j = kCells - i; j < kCells; ++j) {
+                overflow = overflow || (lhs_abs[i] != 0 && rhs_abs[j] != 0);
+            }
+            overflow = overflow || carry != 0;
+        }
+
+        bool negative = lhs.IsNegative() != rhs.IsNegative();
+        CheckOverflow(overflow || !FitsSigned(product, negative));
+        FixedBigInteger res;
+        res.cells_ = negative ? Negated(product) : product;
+        return res;
+    }
+
+    // Quotient is truncated toward zero, remainder of % is never negative
+    friend constexpr FixedBigInteger operator/(const FixedBigInteger& lhs,
+                                               const FixedBigInteger& rhs) {
+        return lhs.DivMod(rhs).first;
+    }
+
+    friend constexpr FixedBigInteger operator%(const FixedBigInteger& lhs,
+                                               const FixedBigInteger& rhs) {
+        // Not through DivMod, the quotient of the minimum by -1 overflows but the
+        // remainder doesn't
+        ContainerType quot{};
+        ContainerType rem{};
+        DivRem(quot, rem, lhs.Magnitude(), Divisor(rhs));
+        FixedBigInteger res;
+        res.cells_ = lhs.IsNegative() ? Negated(rem) : rem;
+        if (res.IsNegative()) {
+            res = rhs.IsNegative() ? res - rhs : res + rhs;
+        }
+        return res;
+    }
+
+    constexpr FixedBigInteger& operator+=(const FixedBigInteger& other) {
+        return *this = *this + other;
+    }
+    constexpr FixedBigInteger& operator-=(const FixedBigInteger& other) {
+        return *this = *this - other;
+    }
+    constexpr FixedBigInteger& operator*=(const FixedBigInteger& other) {
+        return *this = *this * other;
+    }
+    constexpr FixedBigInteger& operator/=(const FixedBigInteger& other) {
+        return *this = *this / other;
+    }
+    constexpr FixedBigInteger& operator%=(const FixedBigInteger& other) {
+        return *this = *this % other;
+    }
+
+    // Quotient and remainder in one division: *this = quotient * other + remainder,
+    // quotient is truncated toward zero and remainder has the sign of *this
+    constexpr std::pair<FixedBigInteger, FixedBigInteger> DivMod(
+        const FixedBigInteger& other) const {
+        ContainerType quot{};
+        ContainerType rem{};
+        DivRem(quot, rem, Magnitude(), Divisor(other));
+
+        // Only the minimum divided by -1 overflows
+        bool negative = IsNegative() != other.IsNegative();
+        CheckOverflow(!FitsSigned(quot, negative));
+        FixedBigInteger quotient;
+        quotient.cells_ = negative ? Negated(quot) : quot;
+        FixedBigInteger remainder;
+        remainder.cells_ = IsNegative() ? Negated(rem) : rem;
+        return {quotient, remainder};
+    }
+
+    /// *this raised to exponent >= 0, 0^0 is 1. Left to right binary powering: every
+    /// partial power divides the result, so only a result out of range overflows
+    constexpr FixedBigInteger Pow(const FixedBigInteger& exponent) const {
+        if (exponent.IsNegative()) {
+            throw std::invalid_argument("FixedBigInteger: negative exponent");
+        }
+        auto bit_set = [&exponent](std::size_t bit) {
+            return ((exponent.cells_[bit / limbs::kCellBits] >> (bit % limbs::kCellBits)) & 1) != 0;
+        };
+        std::size_t bits = Bits;
+        while (bits > 0 && !bit_set(bits - 1)) {
+            --bits;
+        }
+
+        FixedBigInteger res(1);
+        for (std::size_t bit = bits; bit-- > 0;) {
+            res = res * res;
+            if (bit_set(bit)) {
+                res = res * *this;
+            }
+        }
+        return res;
+    }
+
+    friend constexpr bool operator==(const FixedBigInteger& lhs, const FixedBigInteger& rhs) {
+        return Compare(lhs, rhs) == 0;
+    }
+    friend constexpr bool operator!=(const FixedBigInteger& lhs, const FixedBigInteger& rhs) {
+        return Compare(lhs, rhs) != 0;
+    }
+    friend constexpr bool operator<(const FixedBigInteger& lhs, const FixedBigInteger& rhs) {
+        return Compare(lhs, rhs) < 0;
+    }
+    friend constexpr bool operator>(const FixedBigInteger& lhs, const FixedBigInteger& rhs) {
+        return Compare(lhs, rhs) > 0;
+    }
+    friend constexpr bool operator<=(const FixedBigInteger& lhs, const FixedBigInteger& rhs) {
+        return Compare(lhs, rhs) <= 0;
+    }
+    friend constexpr bool operator>=(const FixedBigInteger& lhs, const FixedBigInteger& rhs) {
+        return Compare(lhs, rhs) >= 0;
+    }
+
+    std::string ToString() const {
+        return BigInteger(*this).ToString();
+    }
+
+private:
+    static constexpr CellType kTopBit = CellType{1} << (limbs::kCellBits - 1);
+
+    static constexpr void CheckOverflow(bool overflow) {
+        if (overflow) {
+            throw std::overflow_error("FixedBigInteger: overflow");
+        }
+    }
+
+    static constexpr CellType AddCells(CellType lhs, CellType rhs, CellType& carry) {
+        DoubleCellType sum = static_cast<DoubleCellType>(lhs) + rhs + carry;
+        carry = static_cast<CellType>(sum >> limbs::kCellBits);
+        return static_cast<CellType>(sum);
+    }
+
+    /// 2^Bits - src, the two's complement negation
+    static constexpr ContainerType Negated(const ContainerType& src) {
+        ContainerType res{};
+        CellType carry = 1;
+        for (std::size_t idx = 0; idx < kCells; ++idx) {
+            res[idx] = AddCells(~src[idx], 0, carry);
+        }
+        return res;
+    }
+
+    /// |*this| as an unsigned number, the magnitude of the minimum fits too
+    constexpr ContainerType Magnitude() const {
+        return IsNegative() ? Negated(cells_) : cells_;
+    }
+
+    /// Magnitude of a divisor, throws std::logic_error for zero
+    static constexpr ContainerType Divisor(const FixedBigInteger& den) {
+        ContainerType res = den.Magnitude();
+        if (Size(res) == 0) {
+            throw std::logic_error("div by zero");
+        }
+        return res;
+    }
+
+    /// Whether a number of this magnitude and sign is in range
+    static constexpr bool FitsSigned(const ContainerType& magnitude, bool negative) {
+        if ((magnitude[kCells - 1] & kTopBit) == 0) {
+            return true;
+        }
+        if (!negative || magnitude[kCells - 1] != kTopBit) {
+            return false;
+        }
+        return Size(magnitude, kCells - 1) == 0;
+    }
+
+    /// Cells of the first size without leading zeros
+    static constexpr std::size_t Size(const ContainerType& cells, std::size_t size = kCells) {
+        while (size > 0 && cells[size - 1] == 0) {
+            --size;
+        }
+        return size;
+    }
+
+    static constexpr int Compare(const FixedBigInteger& lhs, const FixedBigInteger& rhs) {
+        if (lhs.IsNegative() != rhs.IsNegative()) {
+            return lhs.IsNegative() ? -1 : 1;
+        }
+        // Numbers of one sign are ordered like their cells as unsigned numbers
+        for (std::size_t idx = kCells; idx-- > 0;) {
+            if (lhs.cells_[idx] != rhs.cells_[idx]) {
+                return lhs.cells_[idx] < rhs.cells_[idx] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /// quot = num / den and rem = num % den of unsigned numbers, den != 0. Knuth's
+    /// algorithm D like limbs::DivRem
+    static constexpr void DivRem(ContainerType& quot, ContainerType& rem,
+                                 const ContainerType& num, const ContainerType& den) {
+        std::size_t num_size = Size(num);
+        std::size_t den_size = Size(den);
+        if (num_size < den_size) {
+            rem = num;
+            return;
+        }
+        if (den_size == 1) {
+            CellType carry = 0;
+            for (std::size_t idx = num_size; idx-- > 0;) {
+                DoubleCellType cur =
+                    (static_cast<DoubleCellType>(carry) << limbs::kCellBits) | num[idx];
+                quot[idx] = static_cast<CellType>(cur / den[0]);
+                carry = static_cast<CellType>(cur % den[0]);
+            }
+            rem[0] = carry;
+            return;
+        }
+
+        // Both are shifted so the top cell of the divisor has the high bit set, then
+        // a quotient cell estimated by the top cells is at most two too large
+        unsigned shift = 0;
+        while ((den[den_size - 1] << shift & kTopBit) == 0) {
+            ++shift;
+        }
+        auto shifted = [shift](const ContainerType& src, std::size_t idx, std::size_t size) {
+            CellType high = idx < size ? src[idx] << shift : 0;
+            CellType low = shift > 0 && idx > 0 ? src[idx - 1] >> (limbs::kCellBits - shift) : 0;
+            return high | low;
+        };
+        std::array<CellType, kCells + 1> rest{};
+        for (std::size_t idx = 0; idx <= num_size; ++idx) {
+            rest[idx] = shifted(num, idx, num_size);
+        }
+        ContainerType div{};
+        for (std::size_t idx = 0; idx < den_size; ++idx) {
+            div[idx] = shifted(den, idx, den_size);
+        }
+
+        CellType top = div[den_size - 1];
+        CellType next = div[den_size - 2];
+        for (std::size_t pos = num_size - den_size + 1; pos-- > 0;) {
+            DoubleCellType head =
+                (static_cast<DoubleCellType>(rest[pos + den_size]) << limbs::kCellBits) |
+                rest[pos + den_size - 1];
+            DoubleCellType estimate = head / top;
+            DoubleCellType remainder = head % top;
+            while ((estimate >> limbs::kCellBits) != 0 ||
+                   estimate * next >
+                       ((remainder << limbs::kCellBits) | rest[pos + den_size - 2])) {
+                --estimate;
+                remainder += top;
+                if ((remainder >> limbs::kCellBits) != 0) {
+                    break;
+                }
+            }
+
+            // rest -= estimate * div at pos, adding div back if it was still too large
+            CellType digit = static_cast<CellType>(estimate);
+            CellType carry = 0;
+            CellType borrow = 0;
+            for (std::size_t idx = 0; idx <= den_size; ++idx) {
+                DoubleCellType product = static_cast<DoubleCellType>(digit) *
+                                             (idx < den_size ? div[idx] : 0) +
+                                         carry;
+                carry = static_cast<CellType>(product >> limbs::kCellBits);
+                DoubleCellType diff = static_cast<DoubleCellType>(rest[pos + idx]) -
+                                      static_cast<CellType>(product) - borrow;
+                rest[pos + idx] = static_cast<CellType>(diff);
+                borrow = (diff >> limbs::kCellBits) != 0 ? 1 : 0;
+            }
+            if (borrow != 0) {
+                --digit;
+                CellType add_carry = 0;
+                for (std::size_t idx = 0; idx < den_size; ++idx) {
+                    rest[pos + idx] = AddCells(rest[pos + idx], div[idx], add_carry);
+                }
+                rest[pos + den_size] += add_carry;
+            }
+            quot[pos] = digit;
+        }
+
+        for (std::size_t idx = 0; idx < den_size; ++idx) {
+            rem[idx] = rest[idx] >> shift |
+                       (shift > 0 ? rest[idx + 1] << (limbs::kCellBits - shift) : 0);
+        }
+    }
+
+    ContainerType cells_{};
+};
+
+template <std::size_t Bits>
+std::ostream& operator<<(std::ostream& out, const FixedBigInteger<Bits>& value) {
+    return out << BigInteger(value);
+}
+
+}  // namespace big_numbers
@@ -0,0 +1,252 @@
+#include "limbs.hpp"
+
+namespace big_numbers::limbs {
+
+namespace {
+
+/// Quotient of high * B + low by a divisor with its top bit set, high < divisor.
+/// inverse is floor((B^2 - 1) / divisor) - B. Moller and Granlund's division by an
+/// invariant integer: the quotient is estimated by one product and corrected at most
+/// twice
+CellType DivStep(CellType high, CellType low, CellType divisor, CellType inverse,
+                 CellType& rem) {
+    DoubleCellType estimate = static_cast<DoubleCellType>(inverse) * high +
+                              ((static_cast<DoubleCellType>(high + 1) << kCellBits) | low);
+    CellType quot = static_cast<CellType>(estimate >> kCellBits);
+    CellType res = low - quot * divisor;
+    if (res > static_cast<CellType>(estimate)) {
+        --quot;
+        res += divisor;
+    }
+    if (res >= divisor) {
+        ++quot;
+        res -= divisor;
+    }
+    rem = res;
+    return quot;
+}
+
+// src << shift is divided by divisor << shift, which has its top bit set: the quotient
+// is the same and the remainder comes out shifted
+template <bool kQuotient>
+CellType DivideByCell(CellType* quot, const CellType* src, std::size_t size, CellType divisor) {
+    if (size == 1) {
+        CellType value = src[0];
+        if (kQuotient) {
+            quot[0] = value / divisor;
+        }
+        return value % divisor;
+    }
+    if (size == 0) {
+        return 0;
+    }
+    unsigned shift = __builtin_clzll(divisor);
+    CellType norm = divisor << shift;
+    auto inverse = static_cast<CellType>(~DoubleCellType{0} / norm);
+
+    CellType rem = shift == 0 ? 0 : src[size - 1] >> (kCellBits - shift);
+    for (std::size_t i = size; i-- > 0;) {
+        CellType low = src[i] << shift;
+        if (shift != 0 && i > 0) {
+            low |= src[i - 1] >> (kCellBits - shift);
+        }
+        CellType digit = DivStep(rem, low, norm, inverse, rem);
+        if (kQuotient) {
+            quot[i] = digit;
+        }
+    }
+    return rem >> shift;
+}
+
+}  // namespace
+
+std::size_t Normalize(const CellType* data, std::size_t size) {
+    while (size > 0 && data[size - 1] == 0) {
+        --size;
+    }
+    return size;
+}
+
+int CompareN(const CellType* lhs, const CellType* rhs, std::size_t size) {
+    while (size-- > 0) {
+        if (lhs[size] != rhs[size]) {
+            return lhs[size] < rhs[size] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+int Compare(const CellType* lhs, std::size_t lhs_size, const CellType* rhs, std::size_t rhs_size) {
+    if (lhs_size != rhs_size) {
+        return lhs_size < rhs_size ? -1 : 1;
+    }
+    return CompareN(lhs, rhs, lhs_size);
+}
+
+CellType AddN(CellType* res, const CellType* lhs, const CellType* rhs, std::size_t size) {
+    CellType carry = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        DoubleCellType sum = static_cast<DoubleCellType>(lhs[i]) + rhs[i] + carry;
+        res[i] = static_cast<CellType>(sum);
+        carry = static_cast<CellType>(sum >> kCellBits);
+    }
+    return carry;
+}
+
+CellType Add(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+             std::size_t rhs_size) {
+    CellType carry = AddN(res, lhs, rhs, rhs_size);
+    return AddOne(res + rhs_size, lhs + rhs_size, lhs_size - rhs_size, carry);
+}
+
+CellType AddOne(CellType* res, const CellType* lhs, std::size_t size, CellType value) {
+    std::size_t idx = 0;
+    for (; idx < size && value != 0; ++idx) {
+        res[idx] = lhs[idx] + value;
+        value = res[idx] < value;
+    }
+    if (res != lhs) {
+        for (; idx < size; ++idx) {
+            res[idx] = lhs[idx];
+        }
+    }
+    return value;
+}
+
+CellType SubN(CellType* res, const CellType* lhs, const CellType* rhs, std::size_t size) {
+    CellType borrow = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        DoubleCellType dif = static_cast<DoubleCellType>(lhs[i]) - rhs[i] - borrow;
+        res[i] = static_cast<CellType>(dif);
+        borrow = static_cast<CellType>(dif >> kCellBits) & 1;
+    }
+    return borrow;
+}
+
+CellType Sub(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+             std::size_t rhs_size) {
+    CellType borrow = SubN(res, lhs, rhs, rhs_size);
+    return SubOne(res + rhs_size, lhs + rhs_size, lhs_size - rhs_size, borrow);
+}
+
+CellType SubOne(CellType* res, const CellType* lhs, std::size_t size, CellType value) {
+    std::size_t idx = 0;
+    for (; idx < size && value != 0; ++idx) {
+        CellType cur = lhs[idx];
+        res[idx] = cur - value;
+        value = cur < value;
+    }
+    if (res != lhs) {
+        for (; idx < size; ++idx) {
+            res[idx] = lhs[idx];
+        }
+    }
+    return value;
+}
+
+CellType MulOne(CellType* res, const CellType* src, std::size_t size, CellType mult) {
+    CellType carry = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        DoubleCellType cur = static_cast<DoubleCellType>(src[i]) * mult + carry;
+        res[i] = static_cast<CellType>(cur);
+        carry = static_cast<CellType>(cur >> kCellBits);
+    }
+    return carry;
+}
+
+CellType AddMulOne(CellType* res, const CellType* src, std::size_t size, CellType mult) {
+    CellType carry = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        // src * mult + res + carry <= (2^64 - 1)^2 + 2 * (2^64 - 1) < 2^128, no overflow here
+        DoubleCellType cur = static_cast<DoubleCellType>(src[i]) * mult + res[i] + carry;
+        res[i] = static_cast<CellType>(cur);
+        carry = static_cast<CellType>(cur >> kCellBits);
+    }
+    return carry;
+}
+
+CellType SubMulOne(CellType* res, const CellType* src, std::size_t size, CellType mult) {
+    CellType borrow = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        DoubleCellType cur = static_cast<DoubleCellType>(src[i]) * mult + borrow;
+        CellType low = static_cast<CellType>(cur);
+        borrow = static_cast<CellType>(cur >> kCellBits) + (res[i] < low);
+        res[i] -= low;
+    }
+    return borrow;
+}
+
+void MulBasecase(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+                 std::size_t rhs_size) {
+    res[lhs_size] = MulOne(res, lhs, lhs_size, rhs[0]);
+    for (std::size_t i = 1; i < rhs_size; ++i) {
+        res[lhs_size + i] = AddMulOne(res + i, lhs, lhs_size, rhs[i]);
+    }
+}
+
+void SqrBasecase(CellType* res, const CellType* src, std::size_t size) {
+    // Products src[i] * src[j] for i < j, each once, then doubled
+    res[0] = 0;
+    res[size] = MulOne(res + 1, src + 1, size - 1, src[0]);
+    for (std::size_t i = 1; i < size; ++i) {
+        res[size + i] = AddMulOne(res + 2 * i + 1, src + i + 1, size - i - 1, src[i]);
+    }
+    ShiftLeft(res, res, 2 * size, 1);
+
+    // and the squares on the diagonal
+    CellType carry = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        DoubleCellType square = static_cast<DoubleCellType>(src[i]) * src[i];
+        DoubleCellType low = static_cast<DoubleCellType>(res[2 * i]) +
+                             static_cast<CellType>(square) + carry;
+        res[2 * i] = static_cast<CellType>(low);
+        DoubleCellType high = static_cast<DoubleCellType>(res[2 * i + 1]) +
+                              static_cast<CellType>(square >> kCellBits) +
+                              static_cast<CellType>(low >> kCellBits);
+        res[2 * i + 1] = static_cast<CellType>(high);
+        carry = static_cast<CellType>(high >> kCellBits);
+    }
+}
+
+CellType DivRemOne(CellType* quot, const CellType* src, std::size_t size, CellType divisor) {
+    return DivideByCell<true>(quot, src, size, divisor);
+}
+
+CellType ModOne(const CellType* src, std::size_t size, CellType divisor) {
+    return DivideByCell<false>(nullptr, src, size, divisor);
+}
+
+CellType ShiftLeft(CellType* res, const CellType* src, std::size_t size, unsigned shift) {
+    CellType out = 0;
+    if (size == 0) {
+        return out;
+    }
+    out = src[size - 1] >> (kCellBits - shift);
+    for (std::size_t i = size - 1; i > 0; --i) {
+        res[i] = (src[i] << shift) | (src[i - 1] >> (kCellBits - shift));
+    }
+    res[0] = src[0] << shift;
+    return out;
+}
+
+CellType ShiftRight(CellType* res, const CellType* src, std::size_t size, unsigned shift) {
+    CellType out = 0;
+    if (size == 0) {
+        return out;
+    }
+    out = src[0] << (kCellBits - shift);
+    for (std::size_t i = 0; i + 1 < size; ++i) {
+        res[i] = (src[i] >> shift) | (src[i + 1] << (kCellBits - shift));
+    }
+    res[size - 1] = src[size - 1] >> shift;
+    return out;
+}
+
+std::size_t BitLength(const CellType* data, std::size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    return size * kCellBits - __builtin_clzll(data[size - 1]);
+}
+
+}  // namespace big_numbers::limbs
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Low level routines over little-endian arrays of 64-bit cells. They know
+// nothing about signs or ownership: the caller passes raw pointers and sizes
+// and takes care of allocating enough room for the result.
+namespace big_numbers::limbs {
+
+using CellType = std::uint64_t;
+using DoubleCellType = unsigned __int128;
+
+static constexpr std::size_t kCellBits = 64;
+
+/// Size of the array without leading (most significant) zero cells
+std::size_t Normalize(const CellType* data, std::size_t size);
+
+/// -1, 0 or 1. Both arrays have the same size
+int CompareN(const CellType* lhs, const CellType* rhs, std::size_t size);
+/// -1, 0 or 1. Both arrays must be normalized
+int Compare(const CellType* lhs, std::size_t lhs_size, const CellType* rhs, std::size_t rhs_size);
+
+/// res = lhs + rhs, returns carry. res may alias lhs or rhs
+CellType AddN(CellType* res, const CellType* lhs, const CellType* rhs, std::size_t size);
+/// res = lhs + rhs where lhs_size >= rhs_size, returns carry. res may alias lhs
+CellType Add(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+             std::size_t rhs_size);
+/// res = lhs + value, returns carry. res may alias lhs
+CellType AddOne(CellType* res, const CellType* lhs, std::size_t size, CellType value);
+
+/// res = lhs - rhs, returns borrow. res may alias lhs or rhs
+CellType SubN(CellType* res, const CellType* lhs, const CellType* rhs, std::size_t size);
+/// res = lhs - rhs where lhs_size >= rhs_size, returns borrow. res may alias lhs
+CellType Sub(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+             std::size_t rhs_size);
+/// res = lhs - value, returns borrow. res may alias lhs
+CellType SubOne(CellType* res, const CellType* lhs, std::size_t size, CellType value);
+
+/// res = src * mult, returns the high cell. res may alias src
+CellType MulOne(CellType* res, const CellType* src, std::size_t size, CellType mult);
+/// res += src * mult, returns carry out of res[size - 1]
+CellType AddMulOne(CellType* res, const CellType* src, std::size_t size, CellType mult);
+/// res -= src * mult, returns borrow out of res[size - 1]
+CellType SubMulOne(CellType* res, const CellType* src, std::size_t size, CellType mult);
+
+/// res = lhs * rhs by the schoolbook method. res has lhs_size + rhs_size cells
+/// and must not overlap the operands
+void MulBasecase(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+                 std::size_t rhs_size);
+/// res = src * src by the schoolbook method with every cross product computed once.
+/// res has 2 * size cells and must not overlap src
+void SqrBasecase(CellType* res, const CellType* src, std::size_t size);
+
+/// quot = src / divisor, returns remainder. quot may alias src. The divisor is
+/// inverted once, every cell then costs a product instead of a division
+CellType DivRemOne(CellType* quot, const CellType* src, std::size_t size, CellType divisor);
+/// src % divisor, DivRemOne without the quotient
+CellType ModOne(const CellType* src, std::size_t size, CellType divisor);
+
+/// res = src << shift for 0 < shift < kCellBits, returns the shifted out bits.
+/// res may alias src
+CellType ShiftLeft(CellType* res, const CellType* src, std::size_t size, unsigned shift);
+/// res = src >> shift for 0 < shift < kCellBits, returns the shifted out bits
+/// (in the high part of the cell). res may alias src
+CellType ShiftRight(CellType* res, const CellType* src, std::size_t size, unsigned shift);
+
+/// Number of significant bits in a normalized array
+std::size_t BitLength(const CellType* data, std::size_t size);
+
+}  // namespace big_numbers::limbs
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <string>
 
+using big_numbers::BigInteger;
+
 int main() {
     BigInteger one, two;
     std::string op;
@@ -20,6 +22,8 @@ int main() {
         result = one / two;
     } else if (op == "%") {
         result = one % two;
+    } else if (op == "^") {
+        result = one.Pow(two);
     } else if (op == "<") {
         result = one < two;
     } else if (op == ">") {
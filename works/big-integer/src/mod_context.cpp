@@ -0,0 +1,236 @@
+#include "mod_context.hpp"
+#include "division.hpp"
+#include "modular.hpp"
+#include "multiplication.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace big_numbers {
+
+namespace {
+
+using CellType = ModContext::CellType;
+
+/// Exponent bits above which a window one bit wider pays for its larger table of
+/// odd powers
+constexpr std::size_t kWindowLimits[] = {7, 25, 81, 241, 673};
+
+bool Bit(const CellType* data, std::size_t idx) {
+    return (data[idx / limbs::kCellBits] >> (idx % limbs::kCellBits)) & 1;
+}
+
+unsigned WindowBits(std::size_t exp_bits) {
+    unsigned bits = 1;
+    for (std::size_t limit : kWindowLimits) {
+        bits += exp_bits > limit ? 1 : 0;
+    }
+    return bits;
+}
+
+}  // namespace
+
+ModContext::ModContext(const BigInteger& modulus) : modulus_(modulus) {
+    modulus_.sign_ = 1;
+    size_ = limbs::Normalize(Mod(), modulus_.container_.size());
+    if (size_ == 0) {
+        throw std::logic_error("div by zero");
+    }
+    product_.resize(2 * size_);
+
+    // B^(2 size) divided by the modulus gives the Barrett reciprocal, and the
+    // remainder takes values to Montgomery form
+    CellVector num(2 * size_ + 1);
+    num[2 * size_] = 1;
+    CellVector quot(size_ + 2);
+    limbs::DivRem(quot.data(), product_.data(), num.data(), num.size(), Mod(), size_,
+                  product_.resource());
+
+    const limbs::ModThresholds& thresholds = limbs::GetModThresholds();
+    bool odd = Mod()[0] % 2 == 1;
+    if (odd && size_ < thresholds.barrett_odd) {
+        reduction_ = Reduction::kMontgomery;
+        inverse_ = limbs::MontgomeryInverse(Mod()[0]);
+        square_.resize(size_);
+        std::copy(product_.begin(), product_.begin() + size_, square_.begin());
+    } else if (odd || size_ >= thresholds.barrett) {
+        reduction_ = Reduction::kBarrett;
+        reciprocal_ = std::move(quot);
+        scratch_.resize(4 * size_ + 5);
+    } else {
+        reduction_ = Reduction::kDivision;
+        scratch_.resize(size_ + 1);
+    }
+}
+
+ModContext::Residue ModContext::Enter(const BigInteger& value) {
+    Residue res;
+    res.cells_.resize(size_, 0);
+    CellType* data = res.cells_.data();
+
+    const CellVector& cells = value.container_;
+    std::size_t value_size = limbs::Normalize(cells.data(), cells.size());
+    if (limbs::Compare(cells.data(), value_size, Mod(), size_) < 0) {
+        std::copy(cells.begin(), cells.begin() + value_size, data);
+        if (value.sign_ < 0 && value_size > 0) {
+            limbs::SubN(data, Mod(), data, size_);
+        }
+    } else {
+        // The only division of a chain
+        BigInteger rem = value % modulus_;
+        std::copy(rem.container_.begin(), rem.container_.end(), data);
+    }
+
+    // x * B^size = x * B^(2 size) / B^size, a Montgomery product with B^(2 size) mod m
+    if (reduction_ == Reduction::kMontgomery) {
+        MulCells(data, data, square_.data());
+    }
+    return res;
+}
+
+BigInteger ModContext::Leave(const Residue& residue) {
+    CellVector cells(size_);
+    if (reduction_ == Reduction::kMontgomery) {
+        std::copy(residue.cells_.begin(), residue.cells_.end(), product_.begin());
+        std::fill(product_.begin() + size_, product_.end(), 0);
+        limbs::MontgomeryReduce(cells.data(), product_.data(), Mod(), size_, inverse_);
+    } else {
+        std::copy(residue.cells_.begin(), residue.cells_.end(), cells.begin());
+    }
+
+    BigInteger res(1, std::move(cells));
+    res.Trim();
+    return res;
+}
+
+ModContext::Residue ModContext::Add(Residue lhs, const Residue& rhs) {
+    CellType* data = lhs.cells_.data();
+    CellType carry = limbs::AddN(data, data, rhs.cells_.data(), size_);
+    if (carry != 0 || limbs::CompareN(data, Mod(), size_) >= 0) {
+        limbs::SubN(data, data, Mod(), size_);
+    }
+    return lhs;
+}
+
+ModContext::Residue ModContext::Sub(Residue lhs, const Residue& rhs) {
+    CellType* data = lhs.cells_.data();
+    if (limbs::SubN(data, data, rhs.cells_.data(), size_) != 0) {
+        limbs::AddN(data, data, Mod(), size_);
+    }
+    return lhs;
+}
+
+ModContext::Residue ModContext::Mul(Residue lhs, const Residue& rhs) {
+    MulCells(lhs.cells_.data(), lhs.cells_.data(), rhs.cells_.data());
+    return lhs;
+}
+
+ModContext::Residue ModContext::Sqr(Residue value) {
+    SqrCells(value.cells_.data(), value.cells_.data());
+    return value;
+}
+
+// Left to right: every bit of exponent costs a squaring, and every run of at most
+// window bits ending with a one costs a multiplication by an odd power from a table
+ModContext::Residue ModContext::Pow(const Residue& value, const BigInteger& exponent) {
+    if (exponent.sign_ < 0) {
+        throw std::invalid_argument("BigInteger: negative exponent");
+    }
+    const CellVector& exp = exponent.container_;
+    std::size_t bits = limbs::BitLength(exp.data(), limbs::Normalize(exp.data(), exp.size()));
+    if (bits == 0) {
+        return Enter(1);
+    }
+    unsigned window = WindowBits(bits);
+
+    // value, value^3, ..., value^(2^window - 1)
+    CellVector table(size_ << (window - 1));
+    std::copy(value.cells_.begin(), value.cells_.end(), table.begin());
+    if (window > 1) {
+        CellVector square(size_);
+        SqrCells(square.data(), table.data());
+        for (std::size_t idx = 1; idx < (std::size_t{1} << (window - 1)); ++idx) {
+            MulCells(table.data() + idx * size_, table.data() + (idx - 1) * size_,
+                     square.data());
+        }
+    }
+
+    // The top bit is set, so the first run starts the power
+    Residue res;
+    res.cells_.resize(size_, 0);
+    CellType* acc = res.cells_.data();
+    bool started = false;
+    for (std::size_t pos = bits; pos > 0;) {
+        if (!Bit(exp.data(), pos - 1)) {
+            SqrCells(acc, acc);
+            --pos;
+            continue;
+        }
+
+        std::size_t low = pos > window ? pos - window : 0;
+        while (!Bit(exp.data(), low)) {
+            ++low;
+        }
+        std::size_t run = 0;
+        for (std::size_t idx = pos; idx-- > low;) {
+            run = (run << 1) | (Bit(exp.data(), idx) ? 1 : 0);
+        }
+        const CellType* power = table.data() + (run >> 1) * size_;
+
+        if (started) {
+            for (std::size_t idx = low; idx < pos; ++idx) {
+                SqrCells(acc, acc);
+            }
+            MulCells(acc, acc, power);
+        } else {
+            std::copy(power, power + size_, acc);
+            started = true;
+        }
+        pos = low;
+    }
+    return res;
+}
+
+const CellType* ModContext::Mod() const {
+    return modulus_.container_.data();
+}
+
+void ModContext::Reduce(CellType* res, CellType* product) {
+    switch (reduction_) {
+        case Reduction::kMontgomery:
+            limbs::MontgomeryReduce(res, product, Mod(), size_, inverse_);
+            break;
+        case Reduction::kBarrett:
+            limbs::BarrettReduce(res, product, Mod(), size_, reciprocal_.data(),
+                                 scratch_.data(), scratch_.resource());
+            break;
+        case Reduction::kDivision: {
+            std::size_t product_size = limbs::Normalize(product, 2 * size_);
+            if (product_size < size_) {
+                std::copy(product, product + product_size, res);
+                std::fill(res + product_size, res + size_, 0);
+            } else {
+                limbs::DivRem(scratch_.data(), res, product, product_size, Mod(), size_,
+                              scratch_.resource());
+            }
+            break;
+        }
+    }
+}
+
+void ModContext::MulCells(CellType* res, const CellType* lhs, const CellType* rhs) {
+    limbs::Mul(product_.data(), lhs, size_, rhs, size_, product_.resource());
+    Reduce(res, product_.data());
+}
+
+void ModContext::SqrCells(CellType* res, const CellType* src) {
+    limbs::Sqr(product_.data(), src, size_, product_.resource());
+    Reduce(res, product_.data());
+}
+
+bool operator==(const ModContext::Residue& lhs, const ModContext::Residue& rhs) {
+    return lhs.cells_.size() == rhs.cells_.size() &&
+           limbs::CompareN(lhs.cells_.data(), rhs.cells_.data(), lhs.cells_.size()) == 0;
+}
+
+}  // namespace big_numbers
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+
+#include "big_integer.hpp"
+#include "cell_vector.hpp"
+
+namespace big_numbers {
+
+/// Arithmetic modulo one fixed modulus. Everything depending on the modulus is
+/// computed once by the constructor, so a product is reduced without a general
+/// division: values are kept as residues in the form of the context, Montgomery
+/// form for odd moduli and plain residues reduced by Barrett's method for even and
+/// large ones. Only small even moduli, where dividing is the fastest, and Enter of
+/// values above the modulus divide (see limbs::ModThresholds). The operations reuse
+/// buffers of the context, so a context is used by one thread at a time
+class ModContext {
+public:
+    using CellType = BigInteger::CellType;
+
+    /// Value modulo the modulus in the form of the context that made it, only that
+    /// context can compute with it. The form is canonical, so equal values compare
+    /// equal
+    class Residue {
+    public:
+        friend bool operator==(const Residue& lhs, const Residue& rhs);
+
+    private:
+        friend class ModContext;
+
+        CellVector cells_;
+    };
+
+    /// Reduces by |modulus|, throws std::logic_error for zero
+    explicit ModContext(const BigInteger& modulus);
+
+    /// |modulus|
+    const BigInteger& Modulus() const {
+        return modulus_;
+    }
+
+    Residue Enter(const BigInteger& value);
+    /// Value of the residue in [0, Modulus())
+    BigInteger Leave(const Residue&);
+
+    // Temporaries given as lhs keep the result, so x = Mul(std::move(x), y) doesn't
+    // allocate
+    Residue Add(Residue lhs, const Residue& rhs);
+    Residue Sub(Residue lhs, const Residue& rhs);
+    Residue Mul(Residue lhs, const Residue& rhs);
+    Residue Sqr(Residue value);
+    /// value raised to exponent >= 0 by a sliding window over the exponent bits
+    Residue Pow(const Residue& value, const BigInteger& exponent);
+
+private:
+    const CellType* Mod() const;
+    /// res = product reduced, product has 2 * size_ cells and is overwritten
+    void Reduce(CellType* res, CellType* product);
+    void MulCells(CellType* res, const CellType* lhs, const CellType* rhs);
+    void SqrCells(CellType* res, const CellType* src);
+
+    enum class Reduction { kMontgomery, kBarrett, kDivision };
+
+    BigInteger modulus_;
+    std::size_t size_;
+    Reduction reduction_;
+    /// Montgomery factor and B^(2 size) mod m
+    CellType inverse_{0};
+    CellVector square_;
+    /// Barrett reciprocal of the modulus
+    CellVector reciprocal_;
+    CellVector product_;
+    /// Temporaries of Barrett reduction or the quotient of a division
+    CellVector scratch_;
+};
+
+bool operator==(const ModContext::Residue& lhs, const ModContext::Residue& rhs);
+
+}  // namespace big_numbers
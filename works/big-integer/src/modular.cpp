@@ -0,0 +1,72 @@
+#include "modular.hpp"
+#include "division.hpp"
+#include "multiplication.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace big_numbers::limbs {
+
+ModThresholds& GetModThresholds() {
+    static ModThresholds thresholds;
+    return thresholds;
+}
+
+CellType MontgomeryInverse(CellType odd) {
+    // odd * odd = 1 mod 8, and every Newton step x * (2 - odd * x) doubles the
+    // number of correct low bits
+    CellType inverse = odd;
+    for (int step = 0; step < 5; ++step) {
+        inverse *= 2 - odd * inverse;
+    }
+    return ~inverse + 1;
+}
+
+void MontgomeryReduce(CellType* res, CellType* src, const CellType* mod, std::size_t size,
+                      CellType inverse) {
+    // Every row clears the lowest cell left by adding a multiple of mod. The carry
+    // out of the top of a row goes to the top cell of the next one
+    CellType carry = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        CellType high = AddMulOne(src + i, mod, size, src[i] * inverse);
+        DoubleCellType sum = static_cast<DoubleCellType>(src[i + size]) + high + carry;
+        src[i + size] = static_cast<CellType>(sum);
+        carry = static_cast<CellType>(sum >> kCellBits);
+    }
+
+    // The high half with the carry is below 2 * mod
+    if (carry != 0 || CompareN(src + size, mod, size) >= 0) {
+        SubN(res, src + size, mod, size);
+    } else if (res != src + size) {
+        std::copy(src + size, src + 2 * size, res);
+    }
+}
+
+void BarrettReciprocal(CellType* recip, const CellType* mod, std::size_t size,
+                       std::pmr::memory_resource* resource) {
+    // One cell more than usual, so a modulus of B^(size - 1) fits too
+    std::pmr::vector<CellType> num(2 * size + 1, 0, resource);
+    num[2 * size] = 1;
+    std::pmr::vector<CellType> rem(size, resource);
+    DivRem(recip, rem.data(), num.data(), num.size(), mod, size, resource);
+}
+
+void BarrettReduce(CellType* res, const CellType* src, const CellType* mod, std::size_t size,
+                   const CellType* recip, CellType* scratch, std::pmr::memory_resource* resource) {
+    // The estimate (src / B^(size - 1)) * recip / B^(size + 1) of the quotient is at
+    // most two too small
+    CellType* estimate = scratch;
+    Mul(estimate, recip, size + 2, src + size - 1, size + 1, resource);
+    CellType* product = scratch + 2 * size + 3;
+    Mul(product, estimate + size + 1, size + 2, mod, size, resource);
+
+    // The remainder is below 3 * mod < B^(size + 1), so the low size + 1 cells of
+    // the difference are enough
+    SubN(product, src, product, size + 1);
+    while (product[size] != 0 || CompareN(product, mod, size) >= 0) {
+        Sub(product, product, size + 1, mod, size);
+    }
+    std::copy(product, product + size, res);
+}
+
+}  // namespace big_numbers::limbs
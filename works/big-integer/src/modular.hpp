@@ -0,0 +1,47 @@
+#pragma once
+
+#include "limbs.hpp"
+
+#include <memory_resource>
+
+// Reductions modulo a fixed number mod of size cells, B = 2^64. Both need a value
+// precomputed from the modulus, after which a product is reduced without division:
+//   - Montgomery reduction of an odd modulus keeps x as x * B^size mod m and reduces
+//     by size multiply-adds of one cell,
+//   - Barrett reduction multiplies by a reciprocal of the modulus, two products that
+//     go through the fast multiplication.
+namespace big_numbers::limbs {
+
+/// Modulus sizes (in cells) at which ModContext switches the reduction
+struct ModThresholds {
+    /// Smaller even moduli are reduced by division, which is faster than Barrett's
+    /// three full products while the division is quadratic too
+    std::size_t barrett = 64;
+    /// From this size on odd moduli are reduced by Barrett instead of Montgomery
+    /// reduction, which stays quadratic
+    std::size_t barrett_odd = 256;
+};
+
+ModThresholds& GetModThresholds();
+
+/// -1 / odd modulo 2^64, the factor of a Montgomery reduction by a modulus whose
+/// low cell is odd
+CellType MontgomeryInverse(CellType odd);
+
+/// res = src / B^size mod mod for src < mod * B^size. src has 2 * size cells and
+/// is overwritten, res has size cells and may alias the high half of src.
+/// inverse is MontgomeryInverse(mod[0])
+void MontgomeryReduce(CellType* res, CellType* src, const CellType* mod, std::size_t size,
+                      CellType inverse);
+
+/// recip = B^(2 size) / mod, size + 2 cells. mod[size - 1] != 0
+void BarrettReciprocal(CellType* recip, const CellType* mod, std::size_t size,
+                       std::pmr::memory_resource* resource);
+
+/// res = src mod mod for src < B^(2 size). src has 2 * size cells, res has size cells
+/// and doesn't overlap src, recip is BarrettReciprocal(mod). scratch has
+/// 4 * size + 5 cells, the products take their temporaries from resource
+void BarrettReduce(CellType* res, const CellType* src, const CellType* mod, std::size_t size,
+                   const CellType* recip, CellType* scratch, std::pmr::memory_resource* resource);
+
+}  // namespace big_numbers::limbs
@@ -0,0 +1,422 @@
+#include "multiplication.hpp"
+#include "ntt.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace big_numbers::limbs {
+
+namespace {
+
+using Cells = std::pmr::vector<CellType>;
+using Resource = std::pmr::memory_resource*;
+
+// Toom-3 interpolation goes through negative values, so its temporaries carry a sign.
+// cells are normalized, zero is an empty vector
+struct SignedCells {
+    bool negative{false};
+    Cells cells;
+};
+
+// A move between vectors of different resources copies the cells, so the arrays the
+// values are moved into start out in the resource of the values
+using Points = std::array<SignedCells, 5>;
+
+Points MakePoints(Resource resource) {
+    return {SignedCells{false, Cells(resource)}, SignedCells{false, Cells(resource)},
+            SignedCells{false, Cells(resource)}, SignedCells{false, Cells(resource)},
+            SignedCells{false, Cells(resource)}};
+}
+
+void MulAny(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+            std::size_t rhs_size, Resource resource) {
+    if (lhs_size >= rhs_size) {
+        Mul(res, lhs, lhs_size, rhs, rhs_size, resource);
+    } else {
+        Mul(res, rhs, rhs_size, lhs, lhs_size, resource);
+    }
+}
+
+void Trim(Cells& cells) {
+    cells.resize(Normalize(cells.data(), cells.size()));
+}
+
+Cells MakeCells(const CellType* data, std::size_t size, Resource resource) {
+    return Cells(data, data + Normalize(data, size), resource);
+}
+
+Cells AddCells(const Cells& lhs, const Cells& rhs, Resource resource) {
+    const Cells& big = lhs.size() >= rhs.size() ? lhs : rhs;
+    const Cells& small = lhs.size() >= rhs.size() ? rhs : lhs;
+
+    Cells res(big.size() + 1, resource);
+    res[big.size()] = Add(res.data(), big.data(), big.size(), small.data(), small.size());
+    Trim(res);
+    return res;
+}
+
+// |lhs - rhs|, negative is set when lhs < rhs
+Cells SubCells(const Cells& lhs, const Cells& rhs, bool& negative, Resource resource) {
+    negative = Compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) < 0;
+    const Cells& big = negative ? rhs : lhs;
+    const Cells& small = negative ? lhs : rhs;
+
+    Cells res(big.size(), resource);
+    Sub(res.data(), big.data(), big.size(), small.data(), small.size());
+    Trim(res);
+    return res;
+}
+
+Cells MulCells(const Cells& lhs, const Cells& rhs, Resource resource) {
+    if (lhs.empty() || rhs.empty()) {
+        return Cells(resource);
+    }
+    Cells res(lhs.size() + rhs.size(), resource);
+    MulAny(res.data(), lhs.data(), lhs.size(), rhs.data(), rhs.size(), resource);
+    Trim(res);
+    return res;
+}
+
+// lhs + rhs with rhs taken negative when rhs_negative is set. rhs comes as bare cells,
+// a SignedCells made for it would copy them
+SignedCells AddSigned(const SignedCells& lhs, bool rhs_negative, const Cells& rhs,
+                      Resource resource) {
+    if (lhs.negative == rhs_negative) {
+        return {lhs.negative, AddCells(lhs.cells, rhs, resource)};
+    }
+    bool negative = false;
+    Cells cells = SubCells(lhs.cells, rhs, negative, resource);
+    return {lhs.negative != negative && !cells.empty(), std::move(cells)};
+}
+
+SignedCells AddSigned(const SignedCells& lhs, const SignedCells& rhs, Resource resource) {
+    return AddSigned(lhs, rhs.negative, rhs.cells, resource);
+}
+
+SignedCells SubSigned(const SignedCells& lhs, const SignedCells& rhs, Resource resource) {
+    return AddSigned(lhs, !rhs.negative && !rhs.cells.empty(), rhs.cells, resource);
+}
+
+SignedCells MulSigned(const SignedCells& lhs, const SignedCells& rhs, Resource resource) {
+    Cells cells = MulCells(lhs.cells, rhs.cells, resource);
+    return {lhs.negative != rhs.negative && !cells.empty(), std::move(cells)};
+}
+
+SignedCells ShiftSigned(SignedCells value, bool left) {
+    if (value.cells.empty()) {
+        return value;
+    }
+    if (left) {
+        value.cells.push_back(0);
+        ShiftLeft(value.cells.data(), value.cells.data(), value.cells.size(), 1);
+    } else {
+        ShiftRight(value.cells.data(), value.cells.data(), value.cells.size(), 1);
+    }
+    Trim(value.cells);
+    return value;
+}
+
+// Division by 3 of a value known to be a multiple of 3
+SignedCells DivExactBy3(SignedCells value) {
+    DivRemOne(value.cells.data(), value.cells.data(), value.cells.size(), 3);
+    Trim(value.cells);
+    return value;
+}
+
+// res[offset..size) += value
+void AddAt(CellType* res, std::size_t size, std::size_t offset, const Cells& value) {
+    if (!value.empty()) {
+        Add(res + offset, res + offset, size - offset, value.data(), value.size());
+    }
+}
+
+// res = |lhs - rhs| on size cells, returns true when lhs < rhs. rhs_size <= size
+bool SubAbs(CellType* res, const CellType* lhs, const CellType* rhs, std::size_t rhs_size,
+            std::size_t size) {
+    std::size_t lhs_size = Normalize(lhs, size);
+    rhs_size = Normalize(rhs, rhs_size);
+    if (Compare(lhs, lhs_size, rhs, rhs_size) >= 0) {
+        Sub(res, lhs, size, rhs, rhs_size);
+        return false;
+    }
+    std::fill(res + rhs_size, res + size, 0);
+    Sub(res, rhs, rhs_size, lhs, lhs_size);
+    return true;
+}
+
+// Splits both operands at half = ceil(lhs_size / 2), requires rhs_size > half:
+//   lhs * rhs = z2 * B^2half + (z0 + z2 - (lhs0 - lhs1)(rhs0 - rhs1)) * B^half + z0
+void Karatsuba(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+               std::size_t rhs_size, Resource resource) {
+    std::size_t half = (lhs_size + 1) / 2;
+    std::size_t res_size = lhs_size + rhs_size;
+    std::size_t high_size = res_size - 2 * half;
+
+    Cells lhs_dif(half, resource);
+    Cells rhs_dif(half, resource);
+    bool lhs_negative = false;
+    bool rhs_negative = false;
+    Cells dif_product(2 * half, resource);
+    RunTasks(3, rhs_size, [&](std::size_t idx) {
+        if (idx == 0) {
+            Mul(res, lhs, half, rhs, half, resource);
+        } else if (idx == 1) {
+            Mul(res + 2 * half, lhs + half, lhs_size - half, rhs + half, rhs_size - half,
+                resource);
+        } else {
+            lhs_negative = SubAbs(lhs_dif.data(), lhs, lhs + half, lhs_size - half, half);
+            rhs_negative = SubAbs(rhs_dif.data(), rhs, rhs + half, rhs_size - half, half);
+            Mul(dif_product.data(), lhs_dif.data(), half, rhs_dif.data(), half, resource);
+        }
+    });
+
+    Cells middle(2 * half + 1, resource);
+    middle[2 * half] = Add(middle.data(), res, 2 * half, res + 2 * half, high_size);
+    if (lhs_negative == rhs_negative) {
+        Sub(middle.data(), middle.data(), middle.size(), dif_product.data(), dif_product.size());
+    } else {
+        Add(middle.data(), middle.data(), middle.size(), dif_product.data(), dif_product.size());
+    }
+
+    Trim(middle);
+    AddAt(res, res_size, half, middle);
+}
+
+Cells SqrCells(const Cells& src, Resource resource) {
+    if (src.empty()) {
+        return Cells(resource);
+    }
+    Cells res(2 * src.size(), resource);
+    Sqr(res.data(), src.data(), src.size(), resource);
+    Trim(res);
+    return res;
+}
+
+SignedCells SqrSigned(const SignedCells& src, Resource resource) {
+    return {false, SqrCells(src.cells, resource)};
+}
+
+// Splits at half = ceil(size / 2), requires size > half. Like Karatsuba with both
+// operands equal, but the middle square is never negative:
+//   src^2 = z2 * B^2half + (z0 + z2 - (src0 - src1)^2) * B^half + z0
+void SqrKaratsuba(CellType* res, const CellType* src, std::size_t size, Resource resource) {
+    std::size_t half = (size + 1) / 2;
+    std::size_t high_size = size - half;
+
+    Cells dif(half, resource);
+    Cells dif_square(2 * half, resource);
+    RunTasks(3, size, [&](std::size_t idx) {
+        if (idx == 0) {
+            Sqr(res, src, half, resource);
+        } else if (idx == 1) {
+            Sqr(res + 2 * half, src + half, high_size, resource);
+        } else {
+            SubAbs(dif.data(), src, src + half, high_size, half);
+            Sqr(dif_square.data(), dif.data(), half, resource);
+        }
+    });
+
+    Cells middle(2 * half + 1, resource);
+    middle[2 * half] = Add(middle.data(), res, 2 * half, res + 2 * half, 2 * high_size);
+    Sub(middle.data(), middle.data(), middle.size(), dif_square.data(), dif_square.size());
+
+    Trim(middle);
+    AddAt(res, 2 * size, half, middle);
+}
+
+// Values of the three parts of part cells of data at 0, 1, -1, -2 and inf
+Points EvaluateToom3(const CellType* data, std::size_t size, std::size_t part,
+                     Resource resource) {
+    Cells low = MakeCells(data, part, resource);
+    Cells mid = MakeCells(data + part, part, resource);
+    Cells high = MakeCells(data + 2 * part, size - 2 * part, resource);
+
+    Points points = MakePoints(resource);
+    Cells low_high = AddCells(low, high, resource);
+    points[1] = {false, AddCells(low_high, mid, resource)};
+    bool negative = false;
+    Cells minus_one = SubCells(low_high, mid, negative, resource);
+    points[2] = {negative && !minus_one.empty(), std::move(minus_one)};
+    // low - 2 * mid + 4 * high = 2 * (2 * high - mid) + low
+    SignedCells twice_high = ShiftSigned({false, Cells(high, resource)}, true);
+    SignedCells minus_two =
+        ShiftSigned(AddSigned(twice_high, !mid.empty(), mid, resource), true);
+    points[3] = AddSigned(minus_two, false, low, resource);
+    points[0] = {false, std::move(low)};
+    points[4] = {false, std::move(high)};
+    return points;
+}
+
+// res = the product with the given values at 0, 1, -1, -2 and inf, interpolated with
+// the Bodrato sequence
+void InterpolateToom3(CellType* res, std::size_t res_size, std::size_t part,
+                      const Points& values, Resource resource) {
+    const SignedCells& at_zero = values[0];
+    const SignedCells& at_one = values[1];
+    const SignedCells& at_minus_one = values[2];
+    const SignedCells& at_minus_two = values[3];
+    const SignedCells& at_inf = values[4];
+
+    SignedCells coef3 = DivExactBy3(SubSigned(at_minus_two, at_one, resource));
+    SignedCells coef1 = ShiftSigned(SubSigned(at_one, at_minus_one, resource), false);
+    SignedCells coef2 = SubSigned(at_minus_one, at_zero, resource);
+    SignedCells twice_inf = ShiftSigned({at_inf.negative, Cells(at_inf.cells, resource)}, true);
+    coef3 = AddSigned(ShiftSigned(SubSigned(coef2, coef3, resource), false), twice_inf,
+                      resource);
+    coef2 = SubSigned(AddSigned(coef2, coef1, resource), at_inf, resource);
+    coef1 = SubSigned(coef1, coef3, resource);
+
+    std::fill(res, res + res_size, 0);
+    std::copy(at_zero.cells.begin(), at_zero.cells.end(), res);
+    std::copy(at_inf.cells.begin(), at_inf.cells.end(), res + 4 * part);
+    AddAt(res, res_size, part, coef1.cells);
+    AddAt(res, res_size, 2 * part, coef2.cells);
+    AddAt(res, res_size, 3 * part, coef3.cells);
+}
+
+// Splits both operands into three parts of part = ceil(lhs_size / 3) cells,
+// requires rhs_size > 2 * part. Evaluates at 0, 1, -1, -2, inf and interpolates
+void Toom3(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+           std::size_t rhs_size, Resource resource) {
+    std::size_t part = (lhs_size + 2) / 3;
+
+    Points lhs_points = EvaluateToom3(lhs, lhs_size, part, resource);
+    Points rhs_points = EvaluateToom3(rhs, rhs_size, part, resource);
+
+    Points values = MakePoints(resource);
+    RunTasks(5, rhs_size, [&](std::size_t idx) {
+        values[idx] = MulSigned(lhs_points[idx], rhs_points[idx], resource);
+    });
+    InterpolateToom3(res, lhs_size + rhs_size, part, values, resource);
+}
+
+// Toom3 with both operands equal: one evaluation and five squares
+void SqrToom3(CellType* res, const CellType* src, std::size_t size, Resource resource) {
+    std::size_t part = (size + 2) / 3;
+
+    Points points = EvaluateToom3(src, size, part, resource);
+
+    Points values = MakePoints(resource);
+    RunTasks(5, size,
+             [&](std::size_t idx) { values[idx] = SqrSigned(points[idx], resource); });
+    InterpolateToom3(res, 2 * size, part, values, resource);
+}
+
+// lhs is much longer than rhs: multiply rhs_size-long slices of lhs and add them up
+void MulUnbalanced(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+                   std::size_t rhs_size, Resource resource) {
+    Mul(res, lhs, rhs_size, rhs, rhs_size, resource);
+
+    Cells slice_product(2 * rhs_size, resource);
+    for (std::size_t offset = rhs_size; offset < lhs_size; offset += rhs_size) {
+        std::size_t slice_size = std::min(rhs_size, lhs_size - offset);
+        MulAny(slice_product.data(), lhs + offset, slice_size, rhs, rhs_size, resource);
+
+        CellType carry = AddN(res + offset, res + offset, slice_product.data(), rhs_size);
+        AddOne(res + offset + rhs_size, slice_product.data() + rhs_size, slice_size, carry);
+    }
+}
+
+}  // namespace
+
+MulThresholds& GetMulThresholds() {
+    static MulThresholds thresholds;
+    return thresholds;
+}
+
+MulParallel& GetMulParallel() {
+    static MulParallel parallel;
+    return parallel;
+}
+
+void RunOnPool(ThreadPool& pool, std::size_t count, const std::function<void(std::size_t)>& task) {
+    std::atomic<std::size_t> running{count};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto run = [&](std::size_t idx) {
+        try {
+            task(idx);
+        } catch (...) {
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    for (std::size_t idx = 1; idx < count; ++idx) {
+        pool.Submit([&, pool_ptr = &pool, idx] {
+            run(idx);
+            // Nothing on the stack of RunOnPool may be touched after the last task
+            if (running.fetch_sub(1) == 1) {
+                pool_ptr->Notify();
+            }
+        });
+    }
+    // The calling thread takes the first task and helps with the others while waiting
+    run(0);
+    running.fetch_sub(1);
+    pool.Wait([&] { return running.load() == 0; });
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::pmr::memory_resource* ScratchResource(std::size_t res_size,
+                                           std::pmr::memory_resource* resource) {
+    const MulParallel& parallel = GetMulParallel();
+    if (parallel.pool && 2 * res_size >= parallel.min_cells) {
+        return std::pmr::get_default_resource();
+    }
+    return resource;
+}
+
+void Mul(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+         std::size_t rhs_size, std::pmr::memory_resource* resource) {
+    const MulThresholds& thresholds = GetMulThresholds();
+
+    if (rhs_size < thresholds.karatsuba) {
+        MulBasecase(res, lhs, lhs_size, rhs, rhs_size);
+        return;
+    }
+    resource = ScratchResource(lhs_size + rhs_size, resource);
+    if (rhs_size >= thresholds.ntt) {
+        MulNtt(res, lhs, lhs_size, rhs, rhs_size, resource);
+    } else if (rhs_size >= thresholds.toom3 && rhs_size > 2 * ((lhs_size + 2) / 3)) {
+        Toom3(res, lhs, lhs_size, rhs, rhs_size, resource);
+    } else if (rhs_size > (lhs_size + 1) / 2) {
+        Karatsuba(res, lhs, lhs_size, rhs, rhs_size, resource);
+    } else {
+        MulUnbalanced(res, lhs, lhs_size, rhs, rhs_size, resource);
+    }
+}
+
+void Sqr(CellType* res, const CellType* src, std::size_t size,
+         std::pmr::memory_resource* resource) {
+    const MulThresholds& thresholds = GetMulThresholds();
+
+    // The recursive squares need every part nonempty, like the products in Mul
+    if (size < thresholds.sqr_basecase) {
+        MulBasecase(res, src, size, src, size);
+        return;
+    }
+    if (size < thresholds.karatsuba || size < 2) {
+        SqrBasecase(res, src, size);
+        return;
+    }
+    resource = ScratchResource(2 * size, resource);
+    if (size >= thresholds.ntt) {
+        SqrNtt(res, src, size, resource);
+    } else if (size >= thresholds.toom3 && size > 2 * ((size + 2) / 3)) {
+        SqrToom3(res, src, size, resource);
+    } else {
+        SqrKaratsuba(res, src, size, resource);
+    }
+}
+
+}  // namespace big_numbers::limbs
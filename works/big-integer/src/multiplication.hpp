@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+
+#include "limbs.hpp"
+#include "thread_pool.hpp"
+
+namespace big_numbers::limbs {
+
+/// Operand sizes (in cells) at which Mul switches to the next algorithm.
+/// Can be changed at runtime, e.g. for tuning or for testing the recursive
+/// algorithms on small numbers
+struct MulThresholds {
+    /// Shorter operands are multiplied by the schoolbook method
+    std::size_t karatsuba = 32;
+    /// From this size on Toom-3 is used instead of Karatsuba
+    std::size_t toom3 = 400;
+    /// From this size on the product goes through number-theoretic transforms
+    std::size_t ntt = 4000;
+    /// Below this size a square is computed like any other product, the halved
+    /// schoolbook square doesn't make up for its extra passes yet
+    std::size_t sqr_basecase = 8;
+};
+
+MulThresholds& GetMulThresholds();
+
+/// Threads for the products of large operands, off by default. Karatsuba and Toom-3
+/// compute their sub-products as tasks of the pool, the transform product runs the
+/// transforms of every prime and operand and the blocks of every transform as tasks
+struct MulParallel {
+    /// Not owned and must outlive its use, nullptr keeps every product on the
+    /// calling thread. The calling thread works on the tasks of its product too
+    ThreadPool* pool = nullptr;
+    /// Products with a shorter operand stay on the calling thread. Their
+    /// sub-products take tens of microseconds, far more than handing out a task
+    std::size_t min_cells = 400;
+};
+
+MulParallel& GetMulParallel();
+
+/// Resource for the temporaries of a product of res_size cells. The resource of the
+/// operands needn't be thread safe, so a product that may hand out tasks to the pool
+/// of GetMulParallel() takes them from the default resource. Tasks are handed out
+/// for at most the transform length, which stays below 2 * res_size
+std::pmr::memory_resource* ScratchResource(std::size_t res_size,
+                                           std::pmr::memory_resource* resource);
+
+void RunOnPool(ThreadPool& pool, std::size_t count, const std::function<void(std::size_t)>& task);
+
+/// Calls task(0), ..., task(count - 1) and returns when all of them are done. They
+/// are tasks of the pool of GetMulParallel() when cells, the size of the shorter
+/// operand, reaches its min_cells, and calls in order on this thread otherwise.
+/// An exception of a task is rethrown after all of them end
+template <class Task>
+void RunTasks(std::size_t count, std::size_t cells, const Task& task) {
+    const MulParallel& parallel = GetMulParallel();
+    if (parallel.pool && count > 1 && cells >= parallel.min_cells) {
+        RunOnPool(*parallel.pool, count, task);
+        return;
+    }
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        task(idx);
+    }
+}
+
+/// res = lhs * rhs, picking the algorithm by operand sizes.
+/// res has lhs_size + rhs_size cells and must not overlap the operands,
+/// lhs_size >= rhs_size > 0. Temporaries come from ScratchResource(resource)
+void Mul(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+         std::size_t rhs_size, std::pmr::memory_resource* resource);
+
+/// res = src * src, with a squaring counterpart of every algorithm of Mul at the same
+/// thresholds. res has 2 * size cells and must not overlap src
+void Sqr(CellType* res, const CellType* src, std::size_t size,
+         std::pmr::memory_resource* resource);
+
+}  // namespace big_numbers::limbs
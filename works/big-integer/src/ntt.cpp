@@ -0,0 +1,316 @@
+#include "ntt.hpp"
+#include "multiplication.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace big_numbers::limbs {
+
+namespace {
+
+using Coefficients = std::pmr::vector<CellType>;
+using Resource = std::pmr::memory_resource*;
+
+// Arithmetic modulo an odd mod < 2^62. Multiplication is Montgomery's with R = 2^64:
+// Mul(a, b) = a * b / R, so multiplying by a constant kept as c * R gives a * c
+class Montgomery {
+public:
+    explicit Montgomery(CellType mod) : mod_(mod) {
+        CellType inverse = mod;
+        for (int i = 0; i < 5; ++i) {
+            inverse *= 2 - mod * inverse;
+        }
+        neg_inverse_ = 0 - inverse;
+
+        CellType r_mod = (0 - mod) % mod;
+        r2_ = static_cast<CellType>(static_cast<DoubleCellType>(r_mod) * r_mod % mod);
+    }
+
+    CellType Mod() const {
+        return mod_;
+    }
+
+    CellType Mul(CellType lhs, CellType rhs) const {
+        DoubleCellType product = static_cast<DoubleCellType>(lhs) * rhs;
+        CellType fix = static_cast<CellType>(product) * neg_inverse_;
+        CellType res = static_cast<CellType>(
+            (product + static_cast<DoubleCellType>(fix) * mod_) >> kCellBits);
+        return res >= mod_ ? res - mod_ : res;
+    }
+
+    CellType Add(CellType lhs, CellType rhs) const {
+        CellType res = lhs + rhs;
+        return res >= mod_ ? res - mod_ : res;
+    }
+
+    CellType Sub(CellType lhs, CellType rhs) const {
+        return lhs >= rhs ? lhs - rhs : lhs + mod_ - rhs;
+    }
+
+    /// value * R for value < mod
+    CellType ToMont(CellType value) const {
+        return Mul(value, r2_);
+    }
+
+    /// Any cell reduced below mod, mod > 2^61 so it takes a few subtractions at most
+    CellType Reduce(CellType value) const {
+        while (value >= mod_) {
+            value -= mod_;
+        }
+        return value;
+    }
+
+    /// base and result in Montgomery form
+    CellType Pow(CellType base, CellType exp) const {
+        CellType res = ToMont(1);
+        for (; exp != 0; exp >>= 1) {
+            if (exp & 1) {
+                res = Mul(res, base);
+            }
+            base = Mul(base, base);
+        }
+        return res;
+    }
+
+    /// Inverse of value < mod in Montgomery form
+    CellType Inverse(CellType value) const {
+        return Pow(ToMont(value), mod_ - 2);
+    }
+
+private:
+    CellType mod_;
+    CellType neg_inverse_;
+    CellType r2_;
+};
+
+struct NttPrime {
+    Montgomery mont;
+    /// Primitive root modulo mont.Mod()
+    CellType generator;
+};
+
+// c * 2^k + 1 with k >= 51, ascending
+const std::array<NttPrime, 3>& Primes() {
+    static const std::array<NttPrime, 3> primes = {
+        NttPrime{Montgomery(4179340454199820289ull), 3},   // 29 * 2^57 + 1
+        NttPrime{Montgomery(4512606826625236993ull), 7},   // 501 * 2^53 + 1
+        NttPrime{Montgomery(4546383823830515713ull), 10},  // 2019 * 2^51 + 1
+    };
+    return primes;
+}
+
+// roots[len + j] = w^j for j < len, w is a primitive (2 * len)-th root of unity.
+// Values are in Montgomery form
+Coefficients RootTable(const NttPrime& prime, std::size_t size, bool inverse,
+                       Resource resource) {
+    const Montgomery& mont = prime.mont;
+    CellType root = mont.Pow(mont.ToMont(prime.generator), (mont.Mod() - 1) / size);
+    if (inverse) {
+        root = mont.Pow(root, size - 1);
+    }
+
+    Coefficients roots(std::max<std::size_t>(size, 2), resource);
+    std::size_t half = size / 2;
+    roots[half] = mont.ToMont(1);
+    for (std::size_t j = 1; j < half; ++j) {
+        roots[half + j] = mont.Mul(roots[half + j - 1], root);
+    }
+    for (std::size_t len = half / 2; len > 0; len /= 2) {
+        for (std::size_t j = 0; j < len; ++j) {
+            roots[len + j] = roots[2 * (len + j)];
+        }
+    }
+    return roots;
+}
+
+/// Blocks of a transform that become tasks on a thread pool, see TransformForward
+constexpr std::size_t kParallelBlocks = 16;
+
+// The transforms take Montgomery by value: a local copy can not alias the data
+// being written, so its constants stay in registers. The roots of a stage don't
+// depend on the block, so the stages of a block are the same loops over the block.
+// Decimation in frequency: natural order in, bit reversed order out. The stages go
+// from the top down to the one of length stop_len
+void Forward(Montgomery mont, CellType* data, std::size_t size, std::size_t stop_len,
+             const Coefficients& roots) {
+    for (std::size_t len = size / 2; len >= stop_len && len > 0; len /= 2) {
+        for (std::size_t block = 0; block < size; block += 2 * len) {
+            CellType* low = data + block;
+            CellType* high = low + len;
+            for (std::size_t j = 0; j < len; ++j) {
+                CellType u = low[j];
+                CellType v = high[j];
+                low[j] = mont.Add(u, v);
+                high[j] = mont.Mul(mont.Sub(u, v), roots[len + j]);
+            }
+        }
+    }
+}
+
+// Decimation in time: bit reversed order in, natural order out. Not scaled by 1 / size.
+// The stages go from the one of length start_len up
+void Inverse(Montgomery mont, CellType* data, std::size_t size, std::size_t start_len,
+             const Coefficients& inverse_roots) {
+    for (std::size_t len = start_len; len < size; len *= 2) {
+        for (std::size_t block = 0; block < size; block += 2 * len) {
+            CellType* low = data + block;
+            CellType* high = low + len;
+            for (std::size_t j = 0; j < len; ++j) {
+                CellType u = low[j];
+                CellType v = mont.Mul(high[j], inverse_roots[len + j]);
+                low[j] = mont.Add(u, v);
+                high[j] = mont.Sub(u, v);
+            }
+        }
+    }
+}
+
+// Below the top stages the blocks of size / kParallelBlocks are transforms of their
+// own, which run as tasks on the pool of GetMulParallel()
+void TransformForward(Montgomery mont, Coefficients& data, const Coefficients& roots) {
+    std::size_t size = data.size();
+    std::size_t blocks = std::min(kParallelBlocks, size);
+    std::size_t block_size = size / blocks;
+    Forward(mont, data.data(), size, block_size, roots);
+    RunTasks(blocks, size, [&](std::size_t idx) {
+        Forward(mont, data.data() + idx * block_size, block_size, 1, roots);
+    });
+}
+
+void TransformInverse(Montgomery mont, Coefficients& data, const Coefficients& inverse_roots) {
+    std::size_t size = data.size();
+    std::size_t blocks = std::min(kParallelBlocks, size);
+    std::size_t block_size = size / blocks;
+    RunTasks(blocks, size, [&](std::size_t idx) {
+        Inverse(mont, data.data() + idx * block_size, block_size, 1, inverse_roots);
+    });
+    Inverse(mont, data.data(), size, block_size, inverse_roots);
+}
+
+Coefficients Load(Montgomery mont, const CellType* src, std::size_t src_size, std::size_t size,
+                  Resource resource) {
+    Coefficients res(size, 0, resource);
+    for (std::size_t i = 0; i < src_size; ++i) {
+        res[i] = mont.Reduce(src[i]);
+    }
+    return res;
+}
+
+// Cyclic convolution of length size modulo one prime. rhs == nullptr means lhs * lhs
+Coefficients Convolve(const NttPrime& prime, const CellType* lhs, std::size_t lhs_size,
+                      const CellType* rhs, std::size_t rhs_size, std::size_t size,
+                      Resource resource) {
+    const Montgomery mont = prime.mont;
+    Coefficients roots = RootTable(prime, size, false, resource);
+
+    // Both operands are transformed at once on a pool. The values start out in
+    // resource, so the loaded ones are moved in without a copy
+    Coefficients lhs_values(resource);
+    Coefficients rhs_values(resource);
+    RunTasks(rhs ? 2 : 1, size, [&](std::size_t idx) {
+        Coefficients& values = idx == 0 ? lhs_values : rhs_values;
+        values = Load(mont, idx == 0 ? lhs : rhs, idx == 0 ? lhs_size : rhs_size, size,
+                      resource);
+        TransformForward(mont, values, roots);
+    });
+
+    if (rhs) {
+        for (std::size_t i = 0; i < size; ++i) {
+            lhs_values[i] = mont.Mul(lhs_values[i], rhs_values[i]);
+        }
+    } else {
+        for (std::size_t i = 0; i < size; ++i) {
+            lhs_values[i] = mont.Mul(lhs_values[i], lhs_values[i]);
+        }
+    }
+
+    TransformInverse(mont, lhs_values, RootTable(prime, size, true, resource));
+
+    // Pointwise products lost a factor R, the inverse transform added a factor size:
+    // multiply by R^2 / size, kept in Montgomery form
+    CellType scale = mont.ToMont(mont.Inverse(size % mont.Mod()));
+    for (auto& value : lhs_values) {
+        value = mont.Mul(value, scale);
+    }
+    return lhs_values;
+}
+
+// Garner's reconstruction of every coefficient from its three residues, the
+// coefficients are added up into res with carry propagation
+void Reconstruct(CellType* res, std::size_t res_size, const std::array<Coefficients, 3>& residues) {
+    const auto& primes = Primes();
+    const Montgomery mont1 = primes[1].mont;
+    const Montgomery mont2 = primes[2].mont;
+    const CellType mod0 = primes[0].mont.Mod();
+    const CellType mod1 = mont1.Mod();
+
+    const CellType inv0_mod1 = mont1.Inverse(mod0);
+    const CellType mod0_mod2 = mont2.ToMont(mod0);
+    const DoubleCellType mod01 = static_cast<DoubleCellType>(mod0) * mod1;
+    const CellType inv01_mod2 = mont2.Inverse(static_cast<CellType>(mod01 % mont2.Mod()));
+    const CellType mod01_low = static_cast<CellType>(mod01);
+    const CellType mod01_high = static_cast<CellType>(mod01 >> kCellBits);
+
+    std::array<CellType, 3> carry = {0, 0, 0};
+    std::size_t count = std::min(res_size, residues[0].size());
+    for (std::size_t k = 0; k < res_size; ++k) {
+        DoubleCellType low = 0;
+        DoubleCellType high_low = 0;
+        DoubleCellType high_high = 0;
+        if (k < count) {
+            // value = r0 + mod0 * t1 + mod0 * mod1 * t2
+            CellType r0 = residues[0][k];
+            CellType t1 = mont1.Mul(mont1.Sub(residues[1][k], r0), inv0_mod1);
+            CellType t2 = mont2.Sub(residues[2][k], r0);
+            t2 = mont2.Mul(mont2.Sub(t2, mont2.Mul(t1, mod0_mod2)), inv01_mod2);
+
+            low = static_cast<DoubleCellType>(mod0) * t1 + r0;
+            high_low = static_cast<DoubleCellType>(mod01_low) * t2;
+            high_high = static_cast<DoubleCellType>(mod01_high) * t2;
+        }
+
+        DoubleCellType sum = static_cast<DoubleCellType>(static_cast<CellType>(low)) +
+                             static_cast<CellType>(high_low) + carry[0];
+        res[k] = static_cast<CellType>(sum);
+
+        sum = (sum >> kCellBits) + static_cast<CellType>(low >> kCellBits) +
+              static_cast<CellType>(high_low >> kCellBits) + static_cast<CellType>(high_high) +
+              carry[1];
+        carry[0] = static_cast<CellType>(sum);
+
+        sum = (sum >> kCellBits) + static_cast<CellType>(high_high >> kCellBits) + carry[2];
+        carry[1] = static_cast<CellType>(sum);
+        carry[2] = static_cast<CellType>(sum >> kCellBits);
+    }
+}
+
+void MulNttImpl(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+                std::size_t rhs_size, Resource resource) {
+    std::size_t size = 1;
+    while (size < lhs_size + rhs_size - 1) {
+        size *= 2;
+    }
+
+    // The primes are independent, on a pool their convolutions run at once
+    std::array<Coefficients, 3> residues = {Coefficients(resource), Coefficients(resource),
+                                            Coefficients(resource)};
+    RunTasks(residues.size(), size, [&](std::size_t idx) {
+        residues[idx] = Convolve(Primes()[idx], lhs, lhs_size, rhs, rhs_size, size, resource);
+    });
+    Reconstruct(res, lhs_size + rhs_size, residues);
+}
+
+}  // namespace
+
+void MulNtt(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+            std::size_t rhs_size, std::pmr::memory_resource* resource) {
+    MulNttImpl(res, lhs, lhs_size, rhs, rhs_size, resource);
+}
+
+void SqrNtt(CellType* res, const CellType* src, std::size_t size,
+            std::pmr::memory_resource* resource) {
+    MulNttImpl(res, src, size, nullptr, size, resource);
+}
+
+}  // namespace big_numbers::limbs
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "limbs.hpp"
+
+#include <memory_resource>
+
+// Multiplication through number-theoretic transforms. Every cell is one
+// coefficient; the convolution is computed modulo three primes just below
+// 2^62 and glued back together with the Chinese remainder theorem, which is
+// exact while the transform length stays under 2^51
+namespace big_numbers::limbs {
+
+/// res = lhs * rhs, res has lhs_size + rhs_size cells and must not overlap the operands.
+/// The transforms are taken from resource
+void MulNtt(CellType* res, const CellType* lhs, std::size_t lhs_size, const CellType* rhs,
+            std::size_t rhs_size, std::pmr::memory_resource* resource);
+
+/// res = src * src with one forward transform per prime. res has 2 * size cells
+void SqrNtt(CellType* res, const CellType* src, std::size_t size,
+            std::pmr::memory_resource* resource);
+
+}  // namespace big_numbers::limbs
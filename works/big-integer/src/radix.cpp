@@ -0,0 +1,213 @@
+#include "radix.hpp"
+#include "digits.hpp"
+#include "division.hpp"
+#include "multiplication.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace big_numbers::limbs {
+
+namespace {
+
+using Cells = std::pmr::vector<CellType>;
+using Resource = std::pmr::memory_resource*;
+
+// Largest power of ten that fits into a cell, the basecase moves kDecimalWidth
+// digits at a time
+static constexpr std::size_t kDecimalWidth = 19;
+static constexpr CellType kDecimalModule = 10'000'000'000'000'000'000ull;
+
+constexpr std::array<CellType, kDecimalWidth + 1> PowersOfTen() {
+    std::array<CellType, kDecimalWidth + 1> res{1};
+    for (std::size_t idx = 1; idx < res.size(); ++idx) {
+        res[idx] = res[idx - 1] * 10;
+    }
+    return res;
+}
+
+static constexpr std::array<CellType, kDecimalWidth + 1> kPowersOfTen = PowersOfTen();
+
+// 10^(kDecimalWidth * 2^level), normalized. Squared up from the previous level on
+// first use and kept for the lifetime of the program, std::deque keeps the returned
+// references valid while it grows. The powers outlive any resource of the numbers,
+// so they are allocated with new and delete.
+// The square is taken without the lock: on a pool, Sqr waits by running other tasks,
+// which may convert numbers too and come back here on the same thread. A power
+// squared by two threads at once is published once, the other copy is dropped
+const Cells& DecimalPower(std::size_t level) {
+    static std::mutex mutex;
+    static std::deque<Cells> powers;
+
+    std::pmr::memory_resource* heap = std::pmr::new_delete_resource();
+    std::unique_lock<std::mutex> lock(mutex);
+    if (powers.empty()) {
+        powers.push_back(Cells({kDecimalModule}, heap));
+    }
+    while (powers.size() <= level) {
+        std::size_t next_level = powers.size();
+        const Cells& prev = powers.back();
+        lock.unlock();
+
+        Cells next(2 * prev.size(), heap);
+        Sqr(next.data(), prev.data(), prev.size(), heap);
+        next.resize(Normalize(next.data(), next.size()));
+
+        lock.lock();
+        if (powers.size() == next_level) {
+            powers.push_back(std::move(next));
+        }
+    }
+    return powers[level];
+}
+
+std::size_t ChunkDigits(CellType chunk) {
+    std::size_t digits = 1;
+    for (; chunk >= 10; chunk /= 10) {
+        ++digits;
+    }
+    return digits;
+}
+
+// Peels off kDecimalWidth digits at a time. width == 0 writes no leading zeros,
+// otherwise exactly width digits
+char* WriteBasecase(char* first, char* last, const CellType* src, std::size_t size,
+                    std::size_t width, Resource resource) {
+    Cells cur(src, src + size, resource);
+    Cells chunks(resource);
+    do {
+        chunks.push_back(DivRemOne(cur.data(), cur.data(), size, kDecimalModule));
+        size = Normalize(cur.data(), size);
+    } while (size != 0);
+
+    if (width == 0) {
+        width = (chunks.size() - 1) * kDecimalWidth + ChunkDigits(chunks.back());
+    }
+    if (static_cast<std::size_t>(last - first) < width) {
+        return nullptr;
+    }
+
+    char* pos = first + width;
+    for (CellType chunk : chunks) {
+        for (std::size_t idx = 0; idx < kDecimalWidth && pos != first; ++idx, chunk /= 10) {
+            *--pos = static_cast<char>('0' + chunk % 10);
+        }
+    }
+    std::fill(first, pos, '0');
+    return first + width;
+}
+
+// Splits src by the largest cached power of at most half its size: the quotient
+// gives the leading digits, the remainder the trailing ones padded to the power
+char* WriteDecimal(char* first, char* last, const CellType* src, std::size_t size,
+                   std::size_t width, Resource resource) {
+    size = Normalize(src, size);
+    if (size < std::max<std::size_t>(GetRadixThresholds().to_decimal, 2)) {
+        return WriteBasecase(first, last, src, size, width, resource);
+    }
+
+    std::size_t level = 0;
+    while (2 * DecimalPower(level + 1).size() <= size + 1) {
+        ++level;
+    }
+    const Cells& power = DecimalPower(level);
+    std::size_t low_width = kDecimalWidth << level;
+
+    Cells quot(size - power.size() + 1, resource);
+    Cells rem(power.size(), resource);
+    DivRem(quot.data(), rem.data(), src, size, power.data(), power.size(), resource);
+
+    char* mid = WriteDecimal(first, last, quot.data(), quot.size(),
+                             width == 0 ? 0 : width - low_width, resource);
+    if (mid == nullptr) {
+        return nullptr;
+    }
+    return WriteDecimal(mid, last, rem.data(), rem.size(), low_width, resource);
+}
+
+// res = res * 10^k + chunk for every chunk of k <= kDecimalWidth digits
+std::size_t ReadBasecase(CellType* res, const char* digits, std::size_t count) {
+    std::size_t size = 0;
+    std::size_t chunk_size = count % kDecimalWidth;
+    chunk_size = chunk_size == 0 ? kDecimalWidth : chunk_size;
+    for (std::size_t idx = 0; idx < count; idx += chunk_size, chunk_size = kDecimalWidth) {
+        CellType carry = MulOne(res, res, size, kPowersOfTen[chunk_size]);
+        carry += AddOne(res, res, size, ParseDigits(digits + idx, chunk_size));
+        if (carry != 0) {
+            res[size++] = carry;
+        }
+    }
+    return size;
+}
+
+// high * 10^low_width + low, where the low digits take the largest cached power
+// shorter than the whole
+std::size_t ReadDecimal(CellType* res, const char* digits, std::size_t count,
+                        Resource resource) {
+    if (count < std::max<std::size_t>(GetRadixThresholds().from_decimal, 2 * kDecimalWidth)) {
+        return ReadBasecase(res, digits, count);
+    }
+
+    std::size_t level = 0;
+    while ((kDecimalWidth << (level + 1)) < count) {
+        ++level;
+    }
+    const Cells& power = DecimalPower(level);
+    std::size_t low_width = kDecimalWidth << level;
+    std::size_t high_count = count - low_width;
+
+    Cells high(DecimalCells(high_count), resource);
+    std::size_t high_size = ReadDecimal(high.data(), digits, high_count, resource);
+    Cells low(DecimalCells(low_width), resource);
+    std::size_t low_size = ReadDecimal(low.data(), digits + high_count, low_width, resource);
+
+    if (high_size == 0) {
+        std::copy(low.begin(), low.begin() + low_size, res);
+        return low_size;
+    }
+
+    Cells product(high_size + power.size(), resource);
+    if (high_size >= power.size()) {
+        Mul(product.data(), high.data(), high_size, power.data(), power.size(), resource);
+    } else {
+        Mul(product.data(), power.data(), power.size(), high.data(), high_size, resource);
+    }
+    // low < power, so the sum still fits into the product cells
+    Add(product.data(), product.data(), product.size(), low.data(), low_size);
+
+    std::size_t size = Normalize(product.data(), product.size());
+    std::copy(product.begin(), product.begin() + size, res);
+    return size;
+}
+
+}  // namespace
+
+RadixThresholds& GetRadixThresholds() {
+    static RadixThresholds thresholds;
+    return thresholds;
+}
+
+std::size_t DecimalDigits(const CellType* src, std::size_t size) {
+    // 1234 / 4096 is slightly above log10(2)
+    return BitLength(src, size) * 1234 / 4096 + 1;
+}
+
+std::size_t DecimalCells(std::size_t count) {
+    // A cell holds more than kDecimalWidth digits
+    return count / kDecimalWidth + 1;
+}
+
+char* ToDecimal(char* first, char* last, const CellType* src, std::size_t size,
+                std::pmr::memory_resource* resource) {
+    return WriteDecimal(first, last, src, size, 0, resource);
+}
+
+std::size_t FromDecimal(CellType* res, const char* digits, std::size_t count,
+                        std::pmr::memory_resource* resource) {
+    return ReadDecimal(res, digits, count, resource);
+}
+
+}  // namespace big_numbers::limbs
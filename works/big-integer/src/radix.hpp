@@ -0,0 +1,37 @@
+#pragma once
+
+#include "limbs.hpp"
+
+#include <memory_resource>
+
+namespace big_numbers::limbs {
+
+/// Sizes at which decimal conversion switches from the quadratic chunk by chunk
+/// loop to divide and conquer over a cached tree of powers of ten. Can be changed
+/// at runtime like MulThresholds
+struct RadixThresholds {
+    /// Cells of the number written by ToDecimal
+    std::size_t to_decimal = 40;
+    /// Digits read by FromDecimal
+    std::size_t from_decimal = 1000;
+};
+
+RadixThresholds& GetRadixThresholds();
+
+/// Upper bound on the number of decimal digits of a normalized array, at least 1
+std::size_t DecimalDigits(const CellType* src, std::size_t size);
+/// Cells enough to hold any number of count decimal digits
+std::size_t DecimalCells(std::size_t count);
+
+/// Writes the decimal digits of the normalized array src to [first, last), without
+/// leading zeros ("0" when size == 0). Returns one past the last written digit or
+/// nullptr when the digits do not fit. Temporaries come from resource
+char* ToDecimal(char* first, char* last, const CellType* src, std::size_t size,
+                std::pmr::memory_resource* resource);
+
+/// res = value of the count > 0 decimal digits at digits, all of them '0'..'9'.
+/// res has DecimalCells(count) cells. Returns the normalized size of res
+std::size_t FromDecimal(CellType* res, const char* digits, std::size_t count,
+                        std::pmr::memory_resource* resource);
+
+}  // namespace big_numbers::limbs
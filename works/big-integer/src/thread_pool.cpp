@@ -0,0 +1,112 @@
+#include "thread_pool.hpp"
+
+namespace big_numbers {
+
+namespace {
+
+/// Pool and queue of the worker running on this thread
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    for (std::size_t idx = 0; idx <= threads; ++idx) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(threads);
+    for (std::size_t idx = 0; idx < threads; ++idx) {
+        workers_.emplace_back([this, idx] { WorkerLoop(idx); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_up_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(Task task) {
+    std::size_t index = current_pool == this ? current_queue : workers_.size();
+    {
+        std::lock_guard lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+        // Counted before the task can be taken, so the count never drops below zero
+        queued_.fetch_add(1);
+    }
+    // Taking the lock orders the new task before the check of a thread going to sleep
+    { std::lock_guard lock(sleep_mutex_); }
+    wake_up_.notify_one();
+}
+
+void ThreadPool::Wait(const std::function<bool()>& done) {
+    std::size_t index = current_pool == this ? current_queue : workers_.size();
+    while (!done()) {
+        if (RunOne(index)) {
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        wake_up_.wait(lock, [&] { return queued_.load() > 0 || done(); });
+    }
+}
+
+void ThreadPool::Notify() {
+    { std::lock_guard lock(sleep_mutex_); }
+    wake_up_.notify_all();
+}
+
+void ThreadPool::WorkerLoop(std::size_t index) {
+    current_pool = this;
+    current_queue = index;
+    while (true) {
+        if (RunOne(index)) {
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        wake_up_.wait(lock, [this] { return queued_.load() > 0 || stop_; });
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::RunOne(std::size_t index) {
+    Task task;
+    if (!Pop(index, task) && !Steal(index, task)) {
+        return false;
+    }
+    queued_.fetch_sub(1);
+    task();
+    return true;
+}
+
+bool ThreadPool::Pop(std::size_t index, Task& task) {
+    Queue& queue = *queues_[index];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::Steal(std::size_t index, Task& task) {
+    for (std::size_t shift = 1; shift < queues_.size(); ++shift) {
+        Queue& queue = *queues_[(index + shift) % queues_.size()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace big_numbers
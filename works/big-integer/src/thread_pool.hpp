@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace big_numbers {
+
+/// Fixed set of worker threads with a task queue per worker. A worker takes the
+/// newest task of its own queue and, once that is empty, steals the oldest task of
+/// another queue, so related tasks stay on one thread while idle threads pick up
+/// the large pieces of work submitted first
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /// threads workers, with 0 all tasks run on the threads calling Wait
+    explicit ThreadPool(std::size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t Size() const {
+        return workers_.size();
+    }
+
+    /// Queues the task on the queue of the calling worker, tasks from other threads
+    /// go to a shared queue
+    void Submit(Task);
+
+    /// Runs queued tasks on the calling thread until done() holds. done is checked
+    /// again after every task and on Notify
+    void Wait(const std::function<bool()>& done);
+    /// Wakes the threads in Wait to check their condition
+    void Notify();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(std::size_t index);
+    /// Runs one task of queue index or stolen from another queue, false if there is none
+    bool RunOne(std::size_t index);
+    bool Pop(std::size_t index, Task& task);
+    bool Steal(std::size_t index, Task& task);
+
+    /// One queue per worker and the shared queue last
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<std::size_t> queued_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_up_;
+    bool stop_{false};
+};
+
+}  // namespace big_numbers
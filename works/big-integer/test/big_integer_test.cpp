@@ -1,6 +1,23 @@
 #include <gtest/gtest.h>
 
 #include <big_integer.hpp>
+#include <cell_vector.hpp>
+#include <digits.hpp>
+#include <division.hpp>
+#include <fixed_big_integer.hpp>
+#include <mod_context.hpp>
+#include <modular.hpp>
+#include <multiplication.hpp>
+#include <radix.hpp>
+#include <thread_pool.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace big_numbers {
 
@@ -23,6 +40,76 @@ TEST(BigInt, IntToString) {
     EXPECT_EQ("12345", value.ToString());
 }
 
+TEST(BigInt, Chars) {
+    char buffer[8];
+    BigInteger value(-1234567);
+    auto [end, ec] = value.ToChars(buffer, buffer + sizeof(buffer));
+    EXPECT_EQ(std::errc(), ec);
+    EXPECT_EQ("-1234567", std::string_view(buffer, end - buffer));
+    EXPECT_EQ(std::errc::value_too_large, (value * 10).ToChars(buffer, buffer + 8).ec);
+
+    std::string_view text = "-000420+7";
+    auto [ptr, read_ec] = value.FromChars(text.data(), text.data() + text.size());
+    EXPECT_EQ(std::errc(), read_ec);
+    EXPECT_EQ(text.data() + 7, ptr);
+    EXPECT_EQ(-420, value);
+
+    text = "-x";
+    EXPECT_EQ(std::errc::invalid_argument,
+              value.FromChars(text.data(), text.data() + text.size()).ec);
+    EXPECT_EQ(-420, value);
+
+    EXPECT_EQ("0", BigInteger("-0000").ToString());
+    EXPECT_THROW(BigInteger("-"), std::invalid_argument);
+    EXPECT_THROW(BigInteger("12a"), std::invalid_argument);
+}
+
+TEST(BigInt, Digits) {
+    std::string digits = "9876543210123456789";
+    std::uint64_t expected = 0;
+    for (std::size_t count = 0; count <= digits.size(); ++count) {
+        EXPECT_EQ(expected, limbs::ParseDigits(digits.data(), count));
+        expected = count < digits.size() ? expected * 10 + (digits[count] - '0') : expected;
+    }
+
+    // Runs that end at every position of the vector blocks, on every kind of neighbour
+    for (char stop : {'/', ':', ' ', '\0', '\x80', '\xff'}) {
+        std::string text(70, '5');
+        for (std::size_t pos = 0; pos < text.size(); ++pos) {
+            text[pos] = stop;
+            EXPECT_EQ(text.data() + pos, limbs::ScanDigits(text.data(), text.data() + text.size()));
+            EXPECT_EQ(text.data() + pos, limbs::ScanDigits(text.data(), text.data() + pos));
+            text[pos] = '0';
+        }
+        EXPECT_EQ(text.data() + text.size(),
+                  limbs::ScanDigits(text.data(), text.data() + text.size()));
+    }
+}
+
+TEST(BigInt, LongDecimal) {
+    limbs::RadixThresholds& thresholds = limbs::GetRadixThresholds();
+    const limbs::RadixThresholds saved = thresholds;
+
+    std::string digits;
+    for (int i = 0; i < 3000; ++i) {
+        digits += static_cast<char>('0' + (i * 7 + i / 13) % 10);
+    }
+    digits[0] = '9';
+    // 10^1500 has zero cells in the middle of the decimal tree
+    std::string power = "1" + std::string(1500, '0');
+
+    for (limbs::RadixThresholds cur :
+         {limbs::RadixThresholds{1000000, 1000000}, {2, 2}, {5, 100}}) {
+        thresholds = cur;
+        EXPECT_EQ(digits, BigInteger(digits).ToString());
+        EXPECT_EQ("-" + digits, BigInteger("-" + digits).ToString());
+        EXPECT_EQ(power, BigInteger(power).ToString());
+        EXPECT_EQ(BigInteger(power) - 1, BigInteger(std::string(1500, '9')));
+    }
+
+    thresholds = saved;
+}
+
 TEST(BigInt, CopyConstructor) {
     BigInteger value{12345};
     EXPECT_EQ(12345, BigInteger(value));
@@ -34,6 +121,146 @@ TEST(BigInt, MoveConstructor) {
     EXPECT_EQ(12345, other_value);
 }
 
+TEST(BigInt, CellVector) {
+    CellVector small(CellVector::kInlineCapacity, 7);
+    EXPECT_TRUE(small.IsInline());
+
+    CellVector moved(std::move(small));
+    EXPECT_TRUE(moved.IsInline());
+    EXPECT_EQ(CellVector::kInlineCapacity, moved.size());
+    EXPECT_EQ(7, moved.back());
+
+    moved.push_back(8);
+    EXPECT_FALSE(moved.IsInline());
+    EXPECT_EQ(8, moved.back());
+    EXPECT_EQ(7, moved[0]);
+
+    CellVector copy(moved);
+    const CellVector::CellType* heap_data = moved.data();
+    CellVector stolen(std::move(moved));
+    EXPECT_EQ(heap_data, stolen.data());
+    EXPECT_EQ(copy.size(), stolen.size());
+    EXPECT_TRUE(std::equal(copy.begin(), copy.end(), stolen.begin()));
+
+    // Growing within the capacity keeps the cells in place
+    stolen.reserve(16);
+    const CellVector::CellType* reserved_data = stolen.data();
+    for (std::size_t size = 1; size <= 16; ++size) {
+        stolen.resize(size - 1);
+        stolen.resize(size, 0);
+    }
+    EXPECT_EQ(reserved_data, stolen.data());
+    EXPECT_EQ(16, stolen.capacity());
+
+    stolen.resize(1);
+    stolen = CellVector(1, 5);
+    EXPECT_EQ(1, stolen.size());
+    EXPECT_EQ(5, stolen[0]);
+}
+
+namespace {
+
+// Counts what goes through it and takes the memory from an arena
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+    std::size_t live_bytes = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        live_bytes += bytes;
+        return arena_.allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        live_bytes -= bytes;
+        arena_.deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::monotonic_buffer_resource arena_;
+};
+
+}  // namespace
+
+TEST(BigInt, MemoryResource) {
+    CountingResource resource;
+    BigInteger heap("123456789012345678901234567890123456789012345678901234567890");
+    {
+        BigInteger value(heap, &resource);
+        EXPECT_EQ(&resource, value.Resource());
+        EXPECT_EQ(heap, value);
+        EXPECT_EQ(1, resource.allocations);
+
+        // Results take the resource of the left operand
+        BigInteger product = value * heap;
+        BigInteger quotient = product / heap;
+        BigInteger sum = -value + heap;
+        EXPECT_EQ(&resource, product.Resource());
+        EXPECT_EQ(&resource, quotient.Resource());
+        EXPECT_EQ(&resource, sum.Resource());
+        EXPECT_EQ(heap * heap, product);
+        EXPECT_EQ(heap, quotient);
+        EXPECT_EQ(0, sum);
+        EXPECT_EQ(std::pmr::get_default_resource(), (heap * value).Resource());
+
+        // Copies go to the default resource, moves keep theirs, assignments keep
+        // the resource of the target
+        EXPECT_EQ(std::pmr::get_default_resource(), BigInteger(product).Resource());
+        BigInteger moved(std::move(product));
+        EXPECT_EQ(&resource, moved.Resource());
+        BigInteger assigned;
+        assigned = std::move(moved);
+        EXPECT_EQ(std::pmr::get_default_resource(), assigned.Resource());
+        EXPECT_EQ(heap * heap, assigned);
+        value = assigned;
+        EXPECT_EQ(&resource, value.Resource());
+        EXPECT_EQ(heap * heap, value);
+    }
+    EXPECT_EQ(0, resource.live_bytes);
+}
+
+TEST(BigInt, ScratchResource) {
+    // Sizes past the thresholds of the transform product, Toom-3, Karatsuba,
+    // Burnikel-Ziegler division and both divide and conquer decimal conversions
+    BigInteger huge = BigInteger(7).Pow(200'000);
+    BigInteger large = BigInteger(3).Pow(30'000);
+    BigInteger medium = BigInteger(5).Pow(3'000);
+    std::string digits = large.ToString();
+    BigInteger huge_square = huge * huge;
+    BigInteger huge_product = huge * (huge + 1);
+    BigInteger large_product = large * (large + 1);
+    BigInteger medium_product = medium * (medium + 1);
+    BigInteger unbalanced = huge * large;
+    BigInteger quotient = huge / large;
+    BigInteger medium_quotient = large / medium;
+
+    CountingResource resource;
+    CountingResource fallback;
+    std::pmr::memory_resource* saved = std::pmr::set_default_resource(&fallback);
+    {
+        BigInteger x(huge, &resource);
+        BigInteger y(large, &resource);
+        BigInteger z(medium, &resource);
+        EXPECT_EQ(huge_square, x * x);
+        EXPECT_EQ(huge_product, x * (x + 1));
+        EXPECT_EQ(large_product, y * (y + 1));
+        EXPECT_EQ(medium_product, z * (z + 1));
+        EXPECT_EQ(unbalanced, x * y);
+        EXPECT_EQ(quotient, x / y);
+        EXPECT_EQ(medium_quotient, y / z);
+        EXPECT_EQ(digits, y.ToString());
+        BigInteger parsed(&resource);
+        parsed.FromChars(digits.data(), digits.data() + digits.size());
+        EXPECT_EQ(large, parsed);
+    }
+    std::pmr::set_default_resource(saved);
+    EXPECT_EQ(0, fallback.allocations);
+    EXPECT_EQ(0, resource.live_bytes);
+}
+
 TEST(BigInt, PlusOperator) {
     BigInteger one(12345);
     BigInteger two(12345);
@@ -64,6 +291,312 @@ TEST(BigInt, MultOperation) {
               BigInteger("1000000000") * BigInteger("100000000000"));
 }
 
+TEST(BigInt, RecursiveMultiplication) {
+    limbs::MulThresholds& thresholds = limbs::GetMulThresholds();
+    const limbs::MulThresholds saved = thresholds;
+
+    // (10^2000 - 1)^2 = 10^4000 - 2 * 10^2000 + 1
+    BigInteger nines(std::string(2000, '9'));
+    BigInteger nines_copy(nines);
+    std::string square = std::string(1999, '9') + "8" + std::string(1999, '0') + "1";
+    BigInteger short_nines(std::string(300, '9'));
+
+    thresholds = {1000000, 1000000, 1000000};
+    BigInteger unbalanced = nines * short_nines;
+
+    for (limbs::MulThresholds cur : {limbs::MulThresholds{2, 1000000, 1000000},
+                                     {2, 3, 1000000},
+                                     {8, 20, 1000000},
+                                     {32, 60, 1000000},
+                                     {2, 3, 1},
+                                     {32, 60, 20}}) {
+        thresholds = cur;
+        EXPECT_EQ(square, (nines * nines).ToString());
+        EXPECT_EQ(square, (nines * nines_copy).ToString());
+        EXPECT_EQ(square, nines.Square().ToString());
+        EXPECT_EQ(unbalanced, nines * short_nines);
+        EXPECT_EQ(unbalanced, short_nines * -nines * -1);
+    }
+
+    thresholds = saved;
+}
+
+TEST(BigInt, Square) {
+    limbs::MulThresholds& thresholds = limbs::GetMulThresholds();
+    const limbs::MulThresholds saved = thresholds;
+
+    // Cells of all ones and of mixed values, so the recursive squares see carries
+    // and differences of both signs
+    std::vector<BigInteger> values = {0, 1, -1, BigInteger("18446744073709551615")};
+    BigInteger mixed = 1;
+    for (int i = 1; i < 150; ++i) {
+        mixed = mixed * BigInteger("18446744073709551557") + i * i;
+        if (i % 7 == 0) {
+            values.push_back(mixed);
+            values.push_back(-(mixed * BigInteger("18446744073709551616") - 1));
+        }
+    }
+
+    for (limbs::MulThresholds cur : {limbs::MulThresholds{1000000, 1000000, 1000000, 0},
+                                     {2, 1000000, 1000000, 0},
+                                     {2, 3, 1000000, 2},
+                                     {8, 20, 1000000, 4},
+                                     {4, 10, 40, 1}}) {
+        std::vector<BigInteger> expected;
+        thresholds = {1000000, 1000000, 1000000, 1000000};
+        for (const BigInteger& value : values) {
+            expected.push_back(value * (value + 1) - value);
+        }
+        thresholds = cur;
+        for (std::size_t idx = 0; idx < values.size(); ++idx) {
+            BigInteger copy = values[idx];
+            EXPECT_EQ(expected[idx], values[idx].Square());
+            EXPECT_EQ(expected[idx], values[idx] * values[idx]);
+            EXPECT_EQ(expected[idx], values[idx] * copy);
+            EXPECT_EQ(-expected[idx], -values[idx] * copy);
+            EXPECT_EQ(values[idx].Pow(4), values[idx].Square().Square());
+        }
+    }
+
+    thresholds = saved;
+}
+
+TEST(BigInt, ParallelMultiplication) {
+    limbs::MulThresholds& thresholds = limbs::GetMulThresholds();
+    const limbs::MulThresholds saved = thresholds;
+    limbs::MulParallel& parallel = limbs::GetMulParallel();
+
+    std::vector<BigInteger> values;
+    BigInteger value = 1;
+    for (int i = 1; i <= 300; ++i) {
+        value = value * BigInteger("18446744073709551557") + i;
+        if (i % 50 == 0) {
+            values.push_back(value);
+        }
+    }
+
+    // Every tier recursing down to tiny sizes, with tasks for all of them
+    for (limbs::MulThresholds cur : {limbs::MulThresholds{4, 1000000, 1000000, 2},
+                                     {4, 10, 1000000, 2},
+                                     {4, 10, 100, 2}}) {
+        thresholds = cur;
+        std::vector<BigInteger> expected;
+        for (const BigInteger& lhs : values) {
+            for (const BigInteger& rhs : values) {
+                expected.push_back(lhs * rhs);
+            }
+            expected.push_back(lhs.Square());
+        }
+
+        ThreadPool pool(3);
+        parallel = {&pool, 1};
+        std::size_t idx = 0;
+        for (const BigInteger& lhs : values) {
+            for (const BigInteger& rhs : values) {
+                EXPECT_EQ(expected[idx++], lhs * rhs);
+            }
+            EXPECT_EQ(expected[idx++], lhs.Square());
+        }
+        parallel = {};
+    }
+
+    thresholds = saved;
+}
+
+TEST(BigInt, ParallelDecimal) {
+    // A conversion squaring new powers of ten waits for the tasks of the squares and
+    // meanwhile runs other tasks of the pool. With a pool the temporaries of the
+    // squares come from the default resource, which queues more conversions here
+    class SubmittingResource : public std::pmr::memory_resource {
+    public:
+        explicit SubmittingResource(std::function<void()> submit) : submit_(std::move(submit)) {
+        }
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            submit_();
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::function<void()> submit_;
+    };
+
+    BigInteger large = BigInteger(2).Pow(400'000);
+    BigInteger small = BigInteger(3).Pow(6'000);
+    std::string small_digits = small.ToString();
+
+    // Without workers every task runs on this thread, inside the squares
+    ThreadPool pool(0);
+    std::vector<std::string> digits(16);
+    std::size_t submitted = 0;
+    std::size_t done = 0;
+    SubmittingResource resource([&] {
+        if (submitted < digits.size()) {
+            pool.Submit([&, idx = submitted] {
+                digits[idx] = small.ToString();
+                ++done;
+            });
+            ++submitted;
+        }
+    });
+
+    limbs::MulParallel& parallel = limbs::GetMulParallel();
+    parallel = {&pool, 1};
+    std::pmr::memory_resource* saved = std::pmr::set_default_resource(&resource);
+    std::string large_digits = large.ToString();
+    pool.Wait([&] { return done == submitted; });
+    std::pmr::set_default_resource(saved);
+    parallel = {};
+
+    EXPECT_EQ(BigInteger(large_digits), large);
+    EXPECT_EQ(digits.size(), submitted);
+    for (const std::string& cur : digits) {
+        EXPECT_EQ(small_digits, cur);
+    }
+}
+
+TEST(BigInt, CompoundOperators) {
+    BigInteger value("340282366920938463463374607431768211455");  // 2^128 - 1
+    value += value;
+    EXPECT_EQ(BigInteger("680564733841876926926749214863536422910"), value);
+    value -= value;
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(value, -value);
+
+    value = -7;
+    value *= BigInteger("18446744073709551616");  // 2^64
+    EXPECT_EQ(BigInteger("-129127208515966861312"), value);
+    value *= value;
+    EXPECT_EQ(BigInteger("16673835979125984709705355764156642361344"), value);
+    value *= 0;
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(value, -value);
+
+    // Temporaries on either side of + and -
+    BigInteger one(5);
+    BigInteger two(-12);
+    EXPECT_EQ(-7, one + BigInteger(two));
+    EXPECT_EQ(17, one - BigInteger(two));
+    EXPECT_EQ(-17, BigInteger(two) - one);
+    EXPECT_EQ(-24, BigInteger(two) + BigInteger(two));
+    EXPECT_EQ(-60, BigInteger(one) * two);
+    EXPECT_EQ(12, -BigInteger(two));
+}
+
+TEST(BigInt, IntegralOperands) {
+    BigInteger big("340282366920938463463374607431768211457");  // 2^128 + 1
+    EXPECT_EQ(BigInteger("340282366920938463463374607431768211464"), big + 7);
+    EXPECT_EQ(BigInteger("340282366920938463463374607431768211450"), big - 7);
+    EXPECT_EQ(BigInteger("-2381976568446569244243622252022377480199"), big * -7);
+    EXPECT_EQ(BigInteger("48611766702991209066196372490252601636"), big / 7);
+    EXPECT_EQ(BigInteger("-48611766702991209066196372490252601636"), big / -7);
+    EXPECT_EQ(5, big % 7);
+    EXPECT_EQ(2, -big % 7);
+    EXPECT_EQ(2, -big % -7);
+
+    // Crossing zero and the cell boundary
+    BigInteger value(5);
+    EXPECT_EQ(-3, value - 8);
+    EXPECT_EQ(3, BigInteger(-5) + 8);
+    EXPECT_EQ(0, value - 5);
+    EXPECT_EQ(value - 5, -(value - 5));
+    EXPECT_EQ(0, value * 0);
+    EXPECT_EQ(value * 0, -(value * 0));
+    EXPECT_EQ(BigInteger("18446744073709551620"), value + UINT64_MAX);
+    EXPECT_EQ(BigInteger("-18446744073709551610"), value - UINT64_MAX);
+    EXPECT_EQ(BigInteger("-9223372036854775813"), value + INT64_MIN - 10);
+    EXPECT_EQ(BigInteger("-46116860184273879040"), value * INT64_MIN);
+    EXPECT_EQ(0, value / INT64_MIN);
+    EXPECT_EQ(BigInteger("18446744073709551610"), -value % UINT64_MAX);
+    EXPECT_EQ(-1, BigInteger("-18446744073709551616") / UINT64_MAX);
+    EXPECT_EQ(0, BigInteger(0) % -3);
+
+    value -= 10;
+    value *= -3;
+    value += 1;
+    EXPECT_EQ(16, value);
+    EXPECT_EQ(BigInteger("-340282366920938463463374607431768211457"), BigInteger(big) * -1);
+    EXPECT_EQ(BigInteger("340282366920938463463374607431768211456"), BigInteger(big) - 1);
+
+    // Division by many cells goes through the inverse of the divisor, a divisor
+    // with the top bit set needs no shift
+    BigInteger power = BigInteger(3).Pow(200);
+    for (std::uint64_t den : {std::uint64_t{3}, std::uint64_t{1000000007}, UINT64_MAX - 58,
+                              std::uint64_t{1} << 63}) {
+        auto [quot, rem] = power.DivMod(BigInteger(0) + den);
+        EXPECT_EQ(quot, power / den);
+        EXPECT_EQ(rem, power % den);
+        EXPECT_EQ(power, power / den * den + power % den);
+    }
+
+    EXPECT_THROW(value / 0, std::logic_error);
+    EXPECT_THROW(value % 0u, std::logic_error);
+
+    EXPECT_TRUE(value == 16);
+    EXPECT_TRUE(16 == value);
+    EXPECT_FALSE(value == -16);
+    EXPECT_FALSE(-big == -1);
+    EXPECT_TRUE(BigInteger(0) == 0u);
+    EXPECT_TRUE(value < 17);
+    EXPECT_TRUE(value > -17);
+    EXPECT_TRUE(value <= 16);
+    EXPECT_TRUE(value >= 16);
+    EXPECT_FALSE(value > UINT64_MAX);
+    EXPECT_TRUE(big > UINT64_MAX);
+    EXPECT_TRUE(-big < INT64_MIN);
+    BigInteger min("-9223372036854775808");
+    EXPECT_TRUE(min == INT64_MIN);
+    EXPECT_TRUE(min <= INT64_MIN);
+    EXPECT_FALSE(min < INT64_MIN);
+    EXPECT_FALSE(min + 1 < INT64_MIN);
+    EXPECT_TRUE(BigInteger(-1) < 0);
+    EXPECT_TRUE(BigInteger(0) > -1);
+}
+
+TEST(BigInt, AddMul) {
+    limbs::MulThresholds& thresholds = limbs::GetMulThresholds();
+    const limbs::MulThresholds saved = thresholds;
+
+    BigInteger nines(std::string(500, '9'));
+    BigInteger ones(std::string(300, '1'));
+    BigInteger small(1000);
+
+    for (std::size_t karatsuba : {1000000, 2}) {
+        thresholds.karatsuba = karatsuba;
+        BigInteger product = nines * ones;
+
+        BigInteger acc = small;
+        acc.AddMul(nines, ones);
+        EXPECT_EQ(small + product, acc);
+        acc.SubMul(nines, ones);
+        EXPECT_EQ(small, acc);
+
+        // Crossing zero in both directions
+        acc.SubMul(ones, -nines);
+        EXPECT_EQ(small + product, acc);
+        acc.SubMul(nines, ones * 2);
+        EXPECT_EQ(small - product, acc);
+        acc.AddMul(-nines, -ones);
+        EXPECT_EQ(small, acc);
+
+        // The accumulator as an operand
+        acc.AddMul(acc, acc);
+        EXPECT_EQ(small + small * small, acc);
+        acc.SubMul(acc, 1);
+        EXPECT_EQ(0, acc);
+        acc.AddMul(nines, 0);
+        EXPECT_EQ(0, acc);
+    }
+
+    thresholds = saved;
+}
+
 TEST(BigInt, DivOperation) {
     BigInteger one(12345);
 
@@ -72,6 +605,253 @@ TEST(BigInt, DivOperation) {
     EXPECT_EQ(1, one % 2);
 }
 
+TEST(BigInt, DivMod) {
+    auto [quot, rem] = BigInteger(-17).DivMod(5);
+    EXPECT_EQ(-3, quot);
+    EXPECT_EQ(-2, rem);
+
+    EXPECT_EQ(-3, BigInteger(-17) / 5);
+    EXPECT_EQ(3, BigInteger(-17) % 5);
+    EXPECT_EQ(3, BigInteger(-17) % -5);
+    EXPECT_EQ(2, BigInteger(17) % -5);
+    EXPECT_THROW(BigInteger(17) / 0, std::logic_error);
+    EXPECT_THROW(BigInteger(17).DivMod(0), std::logic_error);
+}
+
+TEST(BigInt, LongDivision) {
+    limbs::DivThresholds& thresholds = limbs::GetDivThresholds();
+    const limbs::DivThresholds saved = thresholds;
+
+    // (10^3000 - 1) = (10^1000 - 1) * (10^2000 + 10^1000 + 1)
+    BigInteger num(std::string(3000, '9'));
+    BigInteger den(std::string(1000, '9'));
+    BigInteger quot("1" + std::string(999, '0') + "1" + std::string(999, '0') + "1");
+    BigInteger offset("123456789123456789123456789123456789");
+
+    for (std::size_t burnikel_ziegler : {1000000, 60, 4}) {
+        thresholds.burnikel_ziegler = burnikel_ziegler;
+        EXPECT_EQ(quot, num / den);
+        EXPECT_EQ(0, num % den);
+
+        auto [cur_quot, cur_rem] = (num + offset).DivMod(den);
+        EXPECT_EQ(quot, cur_quot);
+        EXPECT_EQ(offset, cur_rem);
+
+        EXPECT_EQ(quot - 1, (num - offset) / den);
+        EXPECT_EQ(den - offset, (num - offset) % den);
+    }
+
+    thresholds = saved;
+}
+
+TEST(BigInt, Pow) {
+    EXPECT_EQ(BigInteger("265613988875874769338781322035779626829233452653394495974574961739092490"
+                         "901302182994384699044001"),
+              BigInteger(3).Pow(200));
+    EXPECT_EQ(-8, BigInteger(-2).Pow(3));
+    EXPECT_EQ(16, BigInteger(-2).Pow(4));
+    EXPECT_EQ(1, BigInteger(0).Pow(0));
+    EXPECT_EQ(0, BigInteger(0).Pow(5));
+
+    BigInteger huge = BigInteger("1" + std::string(30, '0')) + 1;
+    EXPECT_EQ(-1, BigInteger(-1).Pow(huge));
+    EXPECT_THROW(BigInteger(2).Pow(huge), std::length_error);
+    EXPECT_THROW(BigInteger(2).Pow(-1), std::invalid_argument);
+
+    limbs::MulThresholds& thresholds = limbs::GetMulThresholds();
+    const limbs::MulThresholds saved = thresholds;
+    BigInteger base("-98765432109876543210987654321");
+    BigInteger product = 1;
+    for (int idx = 0; idx < 45; ++idx) {
+        product *= base;
+    }
+    for (limbs::MulThresholds cur : {limbs::MulThresholds{},
+                                     {1000000, 1000000, 1000000, 1},
+                                     {2, 3, 1000000},
+                                     {2, 3, 8}}) {
+        thresholds = cur;
+        EXPECT_EQ(product, base.Pow(45));
+        EXPECT_EQ(product * product, base.Pow(90));
+    }
+    thresholds = saved;
+}
+
+TEST(BigInt, PowMod) {
+    EXPECT_EQ(BigInteger("4813934631036521134898629558202816482538"),
+              BigInteger(123456789).PowMod(987654321, BigInteger("1" + std::string(40, '0')) + 7));
+    EXPECT_EQ(BigInteger("311279296875"), BigInteger(-5).PowMod(77, BigInteger("1000000000000")));
+    EXPECT_EQ(1, BigInteger(5).PowMod(0, 7));
+    EXPECT_EQ(0, BigInteger(5).PowMod(0, -1));
+    EXPECT_EQ(0, BigInteger(5).PowMod(3, 1));
+    EXPECT_THROW(BigInteger(5).PowMod(3, 0), std::logic_error);
+    EXPECT_THROW(BigInteger(5).PowMod(-3, 7), std::invalid_argument);
+
+    // Fermat's little theorem for the Mersenne prime 2^521 - 1
+    BigInteger prime = BigInteger(2).Pow(521) - 1;
+    EXPECT_EQ(1, BigInteger(7).PowMod(prime - 1, prime));
+    BigInteger ten_20("1" + std::string(20, '0'));
+    EXPECT_EQ(BigInteger("72890494705969026122"),
+              BigInteger(7).PowMod(BigInteger("1" + std::string(30, '0')) + 1, prime) % ten_20);
+
+    // Odd moduli go through Montgomery reduction, even ones through division
+    BigInteger base("-1234567890123456789012345678901234567890");
+    BigInteger nines(std::string(60, '9'));
+    BigInteger large = BigInteger(3).Pow(500);
+    BigInteger small = BigInteger(7).Pow(30);
+    for (const BigInteger& modulus : {nines, nines - 1, BigInteger(97), BigInteger(96), -nines}) {
+        for (int exp : {1, 2, 3, 10, 31, 100, 1000}) {
+            EXPECT_EQ(base.Pow(exp) % modulus, base.PowMod(exp, modulus));
+        }
+        // Exponents of every window size
+        EXPECT_EQ(base.PowMod(large + small, modulus),
+                  base.PowMod(large, modulus) * base.PowMod(small, modulus) % modulus);
+    }
+}
+
+TEST(BigInt, Sqrt) {
+    EXPECT_EQ(0, BigInteger(0).Sqrt());
+    EXPECT_EQ(1, BigInteger(3).Sqrt());
+    EXPECT_EQ(2, BigInteger(4).Sqrt());
+    BigInteger ten_50("1" + std::string(50, '0'));
+    EXPECT_EQ(ten_50, ten_50.Square().Sqrt());
+    auto [root, rem] = (ten_50.Square() - 1).SqrtRem();
+    EXPECT_EQ(ten_50 - 1, root);
+    EXPECT_EQ(ten_50 + ten_50 - 2, rem);
+    // The estimate of the top two cells rounds up to 2^64
+    EXPECT_EQ(BigInteger(2).Pow(64) - 1, (BigInteger(2).Pow(128) - 1).Sqrt());
+    EXPECT_THROW(BigInteger(-4).Sqrt(), std::invalid_argument);
+    EXPECT_THROW(BigInteger(-4).SqrtRem(), std::invalid_argument);
+
+    // Every number of cells, squares and their neighbours
+    BigInteger value = 7;
+    for (int idx = 0; idx < 60; ++idx) {
+        value = value * BigInteger("98765432109876543211") + idx;
+        auto [root, rem] = value.SqrtRem();
+        EXPECT_EQ(value, root.Square() + rem);
+        EXPECT_TRUE(rem >= 0 && rem <= root + root);
+        EXPECT_EQ(root, value.Sqrt());
+        EXPECT_EQ(value, value.Square().Sqrt());
+        EXPECT_EQ(value - 1, (value.Square() - 1).Sqrt());
+    }
+}
+
+TEST(BigInt, Root) {
+    EXPECT_EQ(3, BigInteger(3).Pow(200).Root(200));
+    EXPECT_EQ(2, BigInteger(26).Root(3));
+    EXPECT_EQ(-3, BigInteger(-27).Root(3));
+    EXPECT_EQ(-3, BigInteger(-63).Root(3));
+    EXPECT_EQ(0, BigInteger(0).Root(5));
+    EXPECT_EQ(-5, BigInteger(-5).Root(1));
+    EXPECT_EQ(2, BigInteger(2).Pow(64).Root(64));
+    EXPECT_EQ(1, BigInteger(2).Pow(64).Root(65));
+    EXPECT_EQ(-1, BigInteger(-2).Pow(63).Root(BigInteger("1" + std::string(30, '0')) + 1));
+    EXPECT_THROW(BigInteger(5).Root(0), std::invalid_argument);
+    EXPECT_THROW(BigInteger(5).Root(-3), std::invalid_argument);
+    EXPECT_THROW(BigInteger(-5).Root(4), std::invalid_argument);
+
+    BigInteger base("123456789012345678901234567890123");
+    for (int degree : {2, 3, 5, 7, 10, 31}) {
+        for (BigInteger root : {base, base.Pow(7) + 1}) {
+            BigInteger power = root.Pow(degree);
+            EXPECT_EQ(root, power.Root(degree));
+            EXPECT_EQ(root - 1, (power - 1).Root(degree));
+            EXPECT_EQ(root, (power + root).Root(degree));
+        }
+    }
+}
+
+TEST(BigInt, Gcd) {
+    EXPECT_EQ(0, BigInteger(0).Gcd(0));
+    EXPECT_EQ(5, BigInteger(0).Gcd(-5));
+    EXPECT_EQ(6, BigInteger(-12).Gcd(18));
+    EXPECT_EQ(12, BigInteger(-4).Lcm(6));
+    EXPECT_EQ(0, BigInteger(0).Lcm(6));
+
+    // Consecutive Fibonacci numbers take the most steps of Euclid's algorithm
+    BigInteger prev = 0;
+    BigInteger fib = 1;
+    for (int idx = 0; idx < 2000; ++idx) {
+        prev += fib;
+        std::swap(prev, fib);
+    }
+    EXPECT_EQ(1, fib.Gcd(prev));
+    EXPECT_EQ(fib * prev, fib.Lcm(prev));
+
+    BigInteger common = BigInteger(3).Pow(300) + 2;
+    BigInteger lhs = common * BigInteger(2).Pow(500) * 15;
+    BigInteger rhs = common * BigInteger(7).Pow(200) * 25;
+    EXPECT_EQ(common * 5, lhs.Gcd(rhs));
+    EXPECT_EQ(common * 5, (-rhs).Gcd(lhs));
+    EXPECT_EQ(common, common.Gcd(0));
+
+    for (auto [a, b] : std::vector<std::pair<BigInteger, BigInteger>>{
+             {lhs, rhs}, {-lhs, rhs}, {fib, -prev}, {0, -7}, {-7, 0}, {0, 0}, {12, 12}}) {
+        auto [gcd, x, y] = a.ExtendedGcd(b);
+        EXPECT_EQ(a.Gcd(b), gcd);
+        EXPECT_EQ(gcd, a * x + b * y);
+    }
+}
+
+TEST(BigInt, ModInverse) {
+    EXPECT_EQ(5, BigInteger(3).ModInverse(7));
+    EXPECT_EQ(2, BigInteger(-3).ModInverse(7));
+    EXPECT_EQ(5, BigInteger(10).ModInverse(-7));
+    EXPECT_EQ(0, BigInteger(10).ModInverse(1));
+    EXPECT_THROW(BigInteger(6).ModInverse(9), std::invalid_argument);
+    EXPECT_THROW(BigInteger(6).ModInverse(0), std::logic_error);
+
+    BigInteger prime = BigInteger(2).Pow(521) - 1;
+    for (BigInteger value : {BigInteger(2), BigInteger(3).Pow(300), -BigInteger(3).Pow(400)}) {
+        BigInteger inverse = value.ModInverse(prime);
+        EXPECT_TRUE(inverse >= 0 && inverse < prime);
+        EXPECT_EQ(1, value * inverse % prime);
+        EXPECT_EQ(value.PowMod(prime - 2, prime), inverse);
+    }
+}
+
+TEST(BigInt, ModContext) {
+    limbs::ModThresholds& thresholds = limbs::GetModThresholds();
+    const limbs::ModThresholds saved = thresholds;
+
+    BigInteger nines(std::string(100, '9'));
+    BigInteger lhs("-123456789012345678901234567890123456789012345678901234567890");
+    BigInteger rhs("987654321098765432109876543210");
+    // Montgomery reduction and division, then Barrett reduction for every modulus
+    for (limbs::ModThresholds cur : {limbs::ModThresholds{1000000, 1000000}, {1, 1}}) {
+        thresholds = cur;
+        for (const BigInteger& modulus : {nines, nines - 1, BigInteger(97), -nines}) {
+            ModContext context(modulus);
+            EXPECT_EQ(modulus < 0 ? -modulus : modulus, context.Modulus());
+
+            ModContext::Residue x = context.Enter(lhs);
+            ModContext::Residue y = context.Enter(rhs);
+            EXPECT_EQ(lhs % modulus, context.Leave(x));
+            EXPECT_EQ((lhs + rhs) % modulus, context.Leave(context.Add(x, y)));
+            EXPECT_EQ((lhs - rhs) % modulus, context.Leave(context.Sub(x, y)));
+            EXPECT_EQ((rhs - lhs) % modulus, context.Leave(context.Sub(y, x)));
+            EXPECT_EQ(lhs * rhs % modulus, context.Leave(context.Mul(x, y)));
+            EXPECT_EQ(lhs * lhs % modulus, context.Leave(context.Sqr(x)));
+            EXPECT_EQ(lhs.Pow(20) % modulus, context.Leave(context.Pow(x, 20)));
+            EXPECT_EQ(context.Enter(1), context.Pow(y, 0));
+            EXPECT_EQ(context.Enter(lhs + modulus * 5), x);
+
+            // A chain of the same values through BigInteger, reduced at every step
+            BigInteger expected = rhs % modulus;
+            ModContext::Residue acc = y;
+            for (int idx = 0; idx < 50; ++idx) {
+                expected = (expected * lhs - rhs) % modulus;
+                acc = context.Sub(context.Mul(std::move(acc), x), y);
+            }
+            EXPECT_EQ(expected, context.Leave(acc));
+        }
+    }
+    thresholds = saved;
+
+    EXPECT_THROW(ModContext(0), std::logic_error);
+    ModContext one(1);
+    EXPECT_EQ(0, one.Leave(one.Pow(one.Enter(5), 3)));
+}
+
 TEST(BigInt, MinusOperation) {
     BigInteger one(12345);
     BigInteger two(12345);
@@ -166,4 +946,124 @@ TEST(BigInt, EqOperation) {
     ASSERT_FALSE(big_negative == big_positive);
 }
 
+TEST(FixedBigInt, Constexpr) {
+    using Fixed = FixedBigInteger<256>;
+    constexpr Fixed kPower = Fixed(3).Pow(100);
+    constexpr Fixed kParsed("515377520732011331036461129765621272702107522001");
+    static_assert(kPower == kParsed);
+    static_assert(kPower / Fixed(3).Pow(99) == 3);
+    static_assert(kPower % 1000 == 1);
+    static_assert(-kPower % 1000 == 999);
+    static_assert((-kPower).DivMod(1000).second == -1);
+    static_assert(Fixed::Min() < -kPower && -kPower < 0 && kPower < Fixed::Max());
+    static_assert(Fixed::Max() + Fixed::Min() == -1);
+    static_assert(Fixed(-1).Cells()[3] == ~Fixed::CellType{0});
+    static_assert(FixedBigInteger<64>(-9) * 7 == -63);
+
+    EXPECT_EQ("-515377520732011331036461129765621272702107522001", (-kPower).ToString());
+}
+
+TEST(FixedBigInt, Arithmetic) {
+    using Fixed = FixedBigInteger<192>;
+    BigInteger max = BigInteger(Fixed::Max());
+    BigInteger min = BigInteger(Fixed::Min());
+    EXPECT_EQ("3138550867693340381917894711603833208051177722232017256447", max.ToString());
+    EXPECT_EQ(-max - 1, min);
+
+    // Values around the cell boundaries and the ends of the range
+    std::vector<BigInteger> values = {0, 1, 2, 3, 10, 97, max, min, max - 1, min + 1};
+    for (std::string digits : {"18446744073709551615", "18446744073709551616",
+                               "340282366920938463463374607431768211455",
+                               "340282366920938463463374607431768211457",
+                               "1234567890123456789012345678901234567890123456",
+                               "98765432109876543210987654321"}) {
+        values.push_back(BigInteger(digits));
+    }
+    std::size_t count = values.size();
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        values.push_back(-values[idx]);
+    }
+
+    auto check = [&](const BigInteger& expected, auto compute) {
+        if (expected < min || expected > max) {
+            EXPECT_THROW(compute(), std::overflow_error) << expected;
+        } else {
+            EXPECT_EQ(expected, BigInteger(compute()));
+        }
+    };
+    for (const BigInteger& lhs : values) {
+        if (lhs < min || lhs > max) {
+            EXPECT_THROW(Fixed{lhs}, std::overflow_error);
+            continue;
+        }
+        Fixed fixed_lhs(lhs);
+        EXPECT_EQ(lhs.ToString(), fixed_lhs.ToString());
+        check(-lhs, [&] { return -fixed_lhs; });
+        for (const BigInteger& rhs : values) {
+            if (rhs < min || rhs > max) {
+                continue;
+            }
+            Fixed fixed_rhs(rhs);
+            check(lhs + rhs, [&] { return fixed_lhs + fixed_rhs; });
+            check(lhs - rhs, [&] { return fixed_lhs - fixed_rhs; });
+            check(lhs * rhs, [&] { return fixed_lhs * fixed_rhs; });
+            EXPECT_EQ(lhs < rhs, fixed_lhs < fixed_rhs);
+            EXPECT_EQ(lhs == rhs, fixed_lhs == fixed_rhs);
+            EXPECT_EQ(lhs >= rhs, fixed_lhs >= fixed_rhs);
+            if (rhs == 0) {
+                EXPECT_THROW(fixed_lhs / fixed_rhs, std::logic_error);
+                continue;
+            }
+            check(lhs / rhs, [&] { return fixed_lhs / fixed_rhs; });
+            check(lhs % rhs, [&] { return fixed_lhs % fixed_rhs; });
+            if (rhs >= 0 && rhs < 200) {
+                check(lhs.Pow(rhs), [&] { return fixed_lhs.Pow(fixed_rhs); });
+            }
+        }
+    }
+}
+
+TEST(FixedBigInt, Conversions) {
+    using Fixed = FixedBigInteger<128>;
+    EXPECT_EQ(Fixed("-170141183460469231731687303715884105728"), Fixed::Min());
+    EXPECT_THROW(Fixed("170141183460469231731687303715884105728"), std::overflow_error);
+    EXPECT_THROW(Fixed("12a"), std::invalid_argument);
+    EXPECT_THROW(Fixed("-"), std::invalid_argument);
+
+    EXPECT_EQ(Fixed(-1), Fixed(std::int64_t{-1}));
+    EXPECT_EQ(BigInteger("18446744073709551615"), BigInteger(Fixed(~std::uint64_t{0})));
+    EXPECT_THROW(FixedBigInteger<64>(~std::uint64_t{0}), std::overflow_error);
+    EXPECT_EQ(BigInteger(0), BigInteger(Fixed(0)));
+    EXPECT_THROW(Fixed(BigInteger(Fixed::Max()) + 1), std::overflow_error);
+    EXPECT_THROW(Fixed::Min() / -1, std::overflow_error);
+    EXPECT_THROW(Fixed(2).Pow(-1), std::invalid_argument);
+
+    std::ostringstream out;
+    out << Fixed(-42);
+    EXPECT_EQ("-42", out.str());
+}
+
+TEST(ThreadPool, Tasks) {
+    ThreadPool pool(3);
+    EXPECT_EQ(3, pool.Size());
+
+    // Tasks submitted from tasks are run too, Wait helps until all of them are done
+    std::atomic<int> done = 0;
+    for (int idx = 0; idx < 100; ++idx) {
+        pool.Submit([&] {
+            pool.Submit([&] { ++done; });
+            ++done;
+        });
+    }
+    pool.Wait([&] { return done.load() == 200; });
+    EXPECT_EQ(200, done.load());
+
+    // Without workers everything runs in Wait
+    ThreadPool empty(0);
+    int counter = 0;
+    empty.Submit([&] { ++counter; });
+    empty.Wait([&] { return counter == 1; });
+    EXPECT_EQ(1, counter);
+}
+
 }  // namespace big_numbers
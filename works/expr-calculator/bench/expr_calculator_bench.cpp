@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+
+#include "calculator.hpp"
+#include "compiler.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "parallel_evaluator.hpp"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace calc {
+
+namespace {
+
+std::string RandomNumber(std::mt19937& gen, std::size_t digits) {
+    std::uniform_int_distribution<int> digit('0', '9');
+    std::string res(1, static_cast<char>(std::uniform_int_distribution<int>('1', '9')(gen)));
+    while (res.size() < digits) {
+        res.push_back(static_cast<char>(digit(gen)));
+    }
+    return res;
+}
+
+// A sum of count short terms like "a * b", "(a - b) * c", "a / b" or "a % b", every
+// number has digits digits. Divisors never start with zero, so the whole expression
+// can be evaluated, and no term multiplies more than two numbers
+std::string RandomExpression(std::size_t count, std::size_t digits) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> kind(0, 4);
+    std::string res;
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        if (idx != 0) {
+            res += gen() % 2 == 0 ? " + " : " - ";
+        }
+        switch (kind(gen)) {
+            case 0:
+                res += RandomNumber(gen, digits);
+                break;
+            case 1:
+                res += RandomNumber(gen, digits) + " * " + RandomNumber(gen, digits);
+                break;
+            case 2:
+                res += "(" + RandomNumber(gen, digits) + " - " + RandomNumber(gen, digits) +
+                       ") * " + RandomNumber(gen, digits);
+                break;
+            case 3:
+                res += RandomNumber(gen, digits) + " / " + RandomNumber(gen, digits);
+                break;
+            default:
+                res += RandomNumber(gen, digits) + " % " + RandomNumber(gen, digits);
+                break;
+        }
+    }
+    return res;
+}
+
+tokenizer::Tokenizer BuildTokenizer(const std::string& expression) {
+    return tokenizer::Tokenizer(std::make_unique<std::istringstream>(expression));
+}
+
+// Arguments: number of terms, digits per number
+void BM_Tokenize(benchmark::State& state) {
+    std::string expression = RandomExpression(state.range(0), state.range(1));
+    for (auto _ : state) {
+        tokenizer::Tokenizer tokenizer = BuildTokenizer(expression);
+        for (; !tokenizer.IsEnd(); tokenizer.Next()) {
+            benchmark::DoNotOptimize(tokenizer.GetToken());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * expression.size());
+}
+
+void BM_TokenizeView(benchmark::State& state) {
+    std::string expression = RandomExpression(state.range(0), state.range(1));
+    for (auto _ : state) {
+        tokenizer::Tokenizer tokenizer{std::string_view(expression)};
+        for (; !tokenizer.IsEnd(); tokenizer.Next()) {
+            benchmark::DoNotOptimize(tokenizer.GetToken());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * expression.size());
+}
+
+void BM_Eval(benchmark::State& state) {
+    std::string expression = RandomExpression(state.range(0), state.range(1));
+    for (auto _ : state) {
+        calculator::Calculator calculator(BuildTokenizer(expression));
+        benchmark::DoNotOptimize(calculator.Eval());
+    }
+    state.SetBytesProcessed(state.iterations() * expression.size());
+}
+
+// Argument: n of the product 1 * 2 * ... * n
+void BM_EvalProduct(benchmark::State& state) {
+    std::string expression = "1";
+    for (std::int64_t factor = 2; factor <= state.range(0); ++factor) {
+        expression += " * " + std::to_string(factor);
+    }
+    for (auto _ : state) {
+        calculator::Calculator calculator(BuildTokenizer(expression));
+        benchmark::DoNotOptimize(calculator.Eval());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The expression is compiled once, only the evaluation is measured
+void BM_Run(benchmark::State& state) {
+    std::string expression = RandomExpression(state.range(0), state.range(1));
+    compiler::Program program = compiler::Compiler(BuildTokenizer(expression)).Compile();
+    compiler::Evaluator evaluator;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluator.Run(program));
+    }
+    state.SetBytesProcessed(state.iterations() * expression.size());
+}
+
+// Arguments: number of terms, digits per number, threads
+void BM_RunParallel(benchmark::State& state) {
+    std::string expression = RandomExpression(state.range(0), state.range(1));
+    compiler::Program program = compiler::Compiler(BuildTokenizer(expression)).Compile();
+    compiler::ParallelEvaluator evaluator({static_cast<std::size_t>(state.range(2))});
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluator.Run(program));
+    }
+    state.SetBytesProcessed(state.iterations() * expression.size());
+}
+
+// Arguments: rows, digits per variable value, whether the program is optimized
+void BM_RunBatch(benchmark::State& state) {
+    compiler::Program program = compiler::Compiler(
+        BuildTokenizer("x * (y + 3) - x % 7 + (y - x) / 5 + (x + y) * (y + x) * (2 * 3 - 5)"))
+                                    .Compile();
+    if (state.range(2)) {
+        program = compiler::Optimize(program);
+    }
+    std::mt19937 gen(42);
+    std::vector<compiler::Evaluator::Column> columns(program.Variables().size());
+    for (auto& column : columns) {
+        for (std::int64_t row = 0; row < state.range(0); ++row) {
+            column.emplace_back(RandomNumber(gen, state.range(1)));
+        }
+    }
+
+    compiler::Evaluator evaluator;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluator.RunBatch(program, columns));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void ExpressionSizes(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"terms", "digits"});
+    for (auto [terms, digits] : {std::pair{100000, 1},
+                                 {100000, 20},
+                                 {10000, 100},
+                                 {1000, 1000},
+                                 {100, 10000},
+                                 {10, 100000}}) {
+        bench->Args({terms, digits});
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_Tokenize)->Apply(ExpressionSizes);
+BENCHMARK(BM_TokenizeView)->Apply(ExpressionSizes);
+BENCHMARK(BM_Eval)->Apply(ExpressionSizes);
+BENCHMARK(BM_EvalProduct)->ArgName("n")->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_Run)->Apply(ExpressionSizes);
+BENCHMARK(BM_RunParallel)
+    ->ArgNames({"terms", "digits", "threads"})
+    ->ArgsProduct({{1000}, {1000}, {1, 2, 4, 8}})
+    ->ArgsProduct({{100}, {10000}, {1, 2, 4, 8}})
+    ->UseRealTime();
+BENCHMARK(BM_RunBatch)
+    ->ArgNames({"rows", "digits", "optimize"})
+    ->ArgsProduct({{100000}, {10}, {0, 1}})
+    ->ArgsProduct({{10000}, {1000}, {0, 1}});
+
+}  // namespace calc
+
+BENCHMARK_MAIN();
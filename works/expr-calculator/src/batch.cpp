@@ -0,0 +1,116 @@
+#include <batch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "calculator.hpp"
+
+#include <thread_pool.hpp>
+
+namespace calc {
+
+namespace {
+
+/// Lines evaluated between two writes of the output
+constexpr std::size_t kBlockLines = 1 << 12;
+/// Fewer lines per thread aren't worth a task
+constexpr std::size_t kMinChunkLines = 64;
+
+class BatchRunner {
+public:
+    BatchRunner(std::ostream& output, std::size_t threads)
+        : output_(output),
+          pool_(std::max<std::size_t>(threads, 1) - 1),
+          calculators_(pool_.Size() + 1),
+          results_(pool_.Size() + 1) {
+    }
+
+    /// Evaluates the lines in chunks, one chunk per thread, and writes the results of
+    /// the chunks in order
+    void Run(const std::vector<std::string_view>& lines) {
+        std::size_t chunk = std::max((lines.size() + calculators_.size() - 1) /
+                                         calculators_.size(),
+                                     kMinChunkLines);
+        std::size_t chunks = (lines.size() + chunk - 1) / chunk;
+        std::atomic<std::size_t> done = 0;
+        for (std::size_t idx = 0; idx < chunks; ++idx) {
+            pool_.Submit([&, idx] {
+                const std::string_view* first = lines.data() + idx * chunk;
+                EvalLines(first, first + std::min(chunk, lines.size() - idx * chunk),
+                          calculators_[idx], results_[idx]);
+                if (done.fetch_add(1) + 1 == chunks) {
+                    pool_.Notify();
+                }
+            });
+        }
+        pool_.Wait([&] { return done.load() == chunks; });
+
+        for (std::size_t idx = 0; idx < chunks; ++idx) {
+            output_.write(results_[idx].data(), static_cast<std::streamsize>(results_[idx].size()));
+        }
+    }
+
+private:
+    static void EvalLines(const std::string_view* first, const std::string_view* last,
+                          calculator::Calculator& calculator, std::string& result) {
+        result.clear();
+        for (; first != last; ++first) {
+            std::string_view line = *first;
+            // Files with Windows line ends
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (!line.empty()) {
+                try {
+                    result += calculator.Eval(line).ToString();
+                } catch (const std::exception& error) {
+                    result += "error: ";
+                    result += error.what();
+                }
+            }
+            result += '\n';
+        }
+    }
+
+    std::ostream& output_;
+    big_numbers::ThreadPool pool_;
+    /// Calculator and output of every chunk of a block, kept for the next block
+    std::vector<calculator::Calculator> calculators_;
+    std::vector<std::string> results_;
+};
+
+}  // namespace
+
+void RunBatch(std::istream& input, std::ostream& output, const BatchOptions& options) {
+    BatchRunner runner(output, options.threads);
+    std::vector<std::string> storage(kBlockLines);
+    std::vector<std::string_view> lines;
+    while (input) {
+        lines.clear();
+        while (lines.size() < kBlockLines && std::getline(input, storage[lines.size()])) {
+            lines.push_back(storage[lines.size()]);
+        }
+        runner.Run(lines);
+    }
+    output.flush();
+}
+
+void RunBatch(std::string_view input, std::ostream& output, const BatchOptions& options) {
+    BatchRunner runner(output, options.threads);
+    std::vector<std::string_view> lines;
+    while (!input.empty()) {
+        lines.clear();
+        while (lines.size() < kBlockLines && !input.empty()) {
+            std::size_t end = std::min(input.find('\n'), input.size());
+            lines.push_back(input.substr(0, end));
+            input.remove_prefix(std::min(end + 1, input.size()));
+        }
+        runner.Run(lines);
+    }
+    output.flush();
+}
+
+}  // namespace calc
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string_view>
+
+namespace calc {
+
+struct BatchOptions {
+    /// Threads evaluating lines, the calling one included
+    std::size_t threads = 1;
+};
+
+/// Evaluates every line of the input as an expression and writes one line per input
+/// line, in the same order: the value, "error: " with the reason, or nothing for an
+/// empty line. Lines are taken in blocks, so the input is never held in memory whole
+/// and the output of a block is written at once
+void RunBatch(std::istream& input, std::ostream& output, const BatchOptions& = {});
+/// Same for text already in memory, e.g. a mapped file. Lines are read in place
+void RunBatch(std::string_view input, std::ostream& output, const BatchOptions& = {});
+
+}  // namespace calc
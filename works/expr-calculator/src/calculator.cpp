@@ -1,79 +1,180 @@
 #include <calculator.hpp>
 
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "functions.hpp"
+
 namespace calc::calculator {
 
 namespace {
 
-using Token = tokenizer::Token;
+/// Bytes of the arena kept by a calculator, longer evaluations take more memory for
+/// the arena from the heap
+constexpr std::size_t kArenaBytes = 1 << 16;
+
+// Product of all factors as a balanced tree: neighbours are multiplied in rounds,
+// so operands of a round have similar sizes and the large products go through the
+// fast multiplication instead of a long accumulator growing by a small factor
+template <class Number>
+Number MultiplyAll(std::pmr::vector<Number>& factors) {
+    while (factors.size() > 1) {
+        std::size_t half = factors.size() / 2;
+        for (std::size_t idx = 0; idx < half; ++idx) {
+            factors[idx] = std::move(factors[2 * idx]) * factors[2 * idx + 1];
+        }
+        if (factors.size() % 2 == 1) {
+            factors[half] = std::move(factors.back());
+            ++half;
+        }
+        factors.resize(half);
+    }
+    return std::move(factors.front());
+}
+
+/// Result of an evaluation moved out of its arena. Fixed width numbers hold no memory
+template <class Number>
+Number Detach(Number&& value) {
+    if constexpr (std::is_same_v<Number, big_numbers::BigInteger>) {
+        return Number(value, std::pmr::get_default_resource());
+    } else {
+        return std::move(value);
+    }
+}
+
+template <class Number>
+Number CallFunction(Function function, const std::pmr::vector<Number>& args) {
+    if constexpr (std::is_same_v<Number, big_numbers::BigInteger>) {
+        return Call(function, args.data());
+    } else {
+        std::vector<big_numbers::BigInteger> values;
+        for (const Number& arg : args) {
+            values.push_back(static_cast<big_numbers::BigInteger>(arg));
+        }
+        return Number(Call(function, values.data()));
+    }
+}
+
+}  // namespace
+
+template <class Number>
+BasicCalculator<Number>::BasicCalculator()
+    : BasicCalculator(tokenizer::Tokenizer(std::string_view())) {
+}
 
+template <class Number>
+BasicCalculator<Number>::BasicCalculator(tokenizer::Tokenizer&& tokenizer)
+    : tokenizer_(std::move(tokenizer)), arena_buffer_(kArenaBytes) {
 }
 
-Calculator::Calculator(tokenizer::Tokenizer&& tokenizer) : tokenizer_(std::move(tokenizer)) {
+template <class Number>
+Number BasicCalculator<Number>::Eval() {
+    // Every number of the evaluation lives in the arena, which is dropped at once at
+    // the end. Only the result is copied out of it
+    std::pmr::monotonic_buffer_resource arena(arena_buffer_.data(), arena_buffer_.size());
+    resource_ = &arena;
+    tokenizer_.SetResource(&arena);
+    try {
+        Number res = Detach(CalcSum());
+        DetachArena();
+        return res;
+    } catch (...) {
+        DetachArena();
+        throw;
+    }
 }
 
-big_numbers::BigInteger Calculator::Eval() {
-    return CalcSum();
+template <class Number>
+Number BasicCalculator<Number>::Eval(std::string_view expression) {
+    tokenizer_ = tokenizer::Tokenizer(expression);
+    Number res = Eval();
+    if (!tokenizer_.IsEnd()) {
+        throw std::runtime_error("Expected end of expression");
+    }
+    return res;
 }
 
-Calculator& Calculator::operator=(Calculator&& other) {
+template <class Number>
+BasicCalculator<Number>& BasicCalculator<Number>::operator=(BasicCalculator&& other) {
     tokenizer_ = std::move(other.tokenizer_);
+    arena_buffer_ = std::move(other.arena_buffer_);
     return *this;
 }
 
-big_numbers::BigInteger Calculator::CalcMult() {
-    Number lhs = GetNumber();
-    Token cur_token = tokenizer_.GetToken();
-    tokenizer::MulOpToken* op_ptr = std::get_if<tokenizer::MulOpToken>(&cur_token);
+template <class Number>
+void BasicCalculator<Number>::DetachArena() {
+    resource_ = std::pmr::get_default_resource();
+    tokenizer_.SetResource(resource_);
+}
+
+template <class Number>
+Number BasicCalculator<Number>::CalcMult() {
+    // Factors of the current run of *, multiplied together only before a / or % and
+    // at the end. Division doesn't commute with them, so it splits the runs
+    std::pmr::vector<Number> factors(resource_);
+    factors.push_back(CalcPower());
 
-    while (!tokenizer_.IsEnd() && op_ptr) {
+    while (auto op_ptr = tokenizer_.PeekIf<tokenizer::MulOpToken>()) {
+        tokenizer::MulOpToken op = *op_ptr;
         tokenizer_.Next();
-        Number rhs = GetNumber();
-
-        if (*op_ptr == tokenizer::MulOpToken::kMult) {
-            lhs *= rhs;
-        } else if (*op_ptr == tokenizer::MulOpToken::kDiv) {
-            lhs = lhs / rhs;
-        } else if (*op_ptr == tokenizer::MulOpToken::kModule) {
-            lhs = lhs % rhs;
+        Number rhs = CalcPower();
+
+        if (op == tokenizer::MulOpToken::kMult) {
+            factors.push_back(std::move(rhs));
+        } else if (op == tokenizer::MulOpToken::kDiv) {
+            Number lhs = MultiplyAll(factors);
+            factors.clear();
+            factors.push_back(lhs / rhs);
+        } else if (op == tokenizer::MulOpToken::kModule) {
+            Number lhs = MultiplyAll(factors);
+            factors.clear();
+            factors.push_back(lhs % rhs);
         }
-
-        cur_token = tokenizer_.GetToken();
-        op_ptr = std::get_if<tokenizer::MulOpToken>(&cur_token);
     }
 
-    return lhs;
+    return MultiplyAll(factors);
 }
 
-big_numbers::BigInteger Calculator::CalcSum() {
-    Number lhs = CalcMult();
-    Token cur_token = tokenizer_.GetToken();
-    tokenizer::AddOpToken* op_ptr = std::get_if<tokenizer::AddOpToken>(&cur_token);
+// The exponent is the rest of the chain, a ^ b ^ c = a ^ (b ^ c)
+template <class Number>
+Number BasicCalculator<Number>::CalcPower() {
+    Number base = GetNumber();
+    if (!tokenizer_.PeekIf<tokenizer::PowOpToken>()) {
+        return base;
+    }
+    tokenizer_.Next();
+    return base.Pow(CalcPower());
+}
 
-    while (!tokenizer_.IsEnd() && op_ptr) {
+// Terms are accumulated in place: adding is linear in the sizes, so a balanced
+// tree of sums would do the same work with more memory
+template <class Number>
+Number BasicCalculator<Number>::CalcSum() {
+    Number lhs = CalcMult();
 
+    while (auto op_ptr = tokenizer_.PeekIf<tokenizer::AddOpToken>()) {
+        tokenizer::AddOpToken op = *op_ptr;
         tokenizer_.Next();
         Number rhs = CalcMult();
 
-        if (*op_ptr == tokenizer::AddOpToken::kPlus) {
+        if (op == tokenizer::AddOpToken::kPlus) {
             lhs += rhs;
-        } else if (*op_ptr == tokenizer::AddOpToken::kMinus) {
+        } else if (op == tokenizer::AddOpToken::kMinus) {
             lhs -= rhs;
         }
-
-        cur_token = tokenizer_.GetToken();
-        op_ptr = std::get_if<tokenizer::AddOpToken>(&cur_token);
     }
 
     return lhs;
 }
 
-big_numbers::BigInteger Calculator::CalcSubExpr() {
-    Token cur_token = tokenizer_.GetToken();
-    tokenizer::BracketToken* bracket_ptr = std::get_if<tokenizer::BracketToken>(&cur_token);
-
+template <class Number>
+Number BasicCalculator<Number>::CalcSubExpr() {
     if (tokenizer_.IsEnd()) {
         return 0;
     }
+    auto bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>();
     if (!bracket_ptr || *bracket_ptr != tokenizer::BracketToken::kOpen) {
         throw std::runtime_error("Expected (");
     }
@@ -81,9 +182,8 @@ big_numbers::BigInteger Calculator::CalcSubExpr() {
     tokenizer_.Next();
     Number res = CalcSum();
 
-    cur_token = tokenizer_.GetToken();
-    bracket_ptr = std::get_if<tokenizer::BracketToken>(&cur_token);
-    if (tokenizer_.IsEnd() || !bracket_ptr || *bracket_ptr != tokenizer::BracketToken::kClose) {
+    bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>();
+    if (!bracket_ptr || *bracket_ptr != tokenizer::BracketToken::kClose) {
         throw std::runtime_error("Expected )");
     }
     tokenizer_.Next();
@@ -91,25 +191,59 @@ big_numbers::BigInteger Calculator::CalcSubExpr() {
     return res;
 }
 
-big_numbers::BigInteger Calculator::GetNumber() {
-    if (tokenizer_.IsEnd()) {
-        throw std::runtime_error("Expression ends unexpectedly. Number or ( is expected");
+// name(argument, ...), every argument is a sum
+template <class Number>
+Number BasicCalculator<Number>::CalcCall() {
+    std::string name = std::get<tokenizer::IdentifierToken>(tokenizer_.Take()).name;
+    std::optional<Function> function = FindFunction(name);
+    if (!function) {
+        throw std::runtime_error("Unknown function '" + name + "'");
     }
-    Token cur_token = tokenizer_.GetToken();
-    tokenizer::NumberToken* number_ptr = std::get_if<tokenizer::NumberToken>(&cur_token);
+    tokenizer_.Next();
 
-    if (!number_ptr) {
-        tokenizer::BracketToken* bracket_ptr = std::get_if<tokenizer::BracketToken>(&cur_token);
+    std::pmr::vector<Number> args(resource_);
+    for (std::size_t idx = 0; idx < Arity(*function); ++idx) {
+        if (idx > 0) {
+            if (!tokenizer_.PeekIf<tokenizer::CommaToken>()) {
+                throw std::runtime_error("Expected ,");
+            }
+            tokenizer_.Next();
+        }
+        args.push_back(CalcSum());
+    }
 
-        return CalcSubExpr();
+    auto bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>();
+    if (!bracket_ptr || *bracket_ptr != tokenizer::BracketToken::kClose) {
+        throw std::runtime_error("Expected )");
+    }
+    tokenizer_.Next();
 
-        if (!bracket_ptr) {
-            throw std::runtime_error("Unexpected token. Number or ( is expected");
+    return CallFunction(*function, args);
+}
+
+template <class Number>
+Number BasicCalculator<Number>::GetNumber() {
+    if (tokenizer_.IsEnd()) {
+        throw std::runtime_error("Expression ends unexpectedly. Number or ( is expected");
+    }
+    if (tokenizer_.PeekIf<tokenizer::IdentifierToken>()) {
+        auto bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>(1);
+        if (bracket_ptr && *bracket_ptr == tokenizer::BracketToken::kOpen) {
+            return CalcCall();
         }
+        throw std::runtime_error("Variables can't be evaluated in place, use compiler::Compiler");
+    }
+    if (!tokenizer_.PeekIf<tokenizer::NumberToken>()) {
+        return CalcSubExpr();
     }
 
-    tokenizer_.Next();
-    return number_ptr->value;
+    // The number is moved out of the tokenizer, its cells are already in the arena
+    return Number(std::get<tokenizer::NumberToken>(tokenizer_.Take()).value);
 }
 
+template class BasicCalculator<big_numbers::BigInteger>;
+template class BasicCalculator<big_numbers::FixedBigInteger<128>>;
+template class BasicCalculator<big_numbers::FixedBigInteger<256>>;
+template class BasicCalculator<big_numbers::FixedBigInteger<512>>;
+
 }  // namespace calc::calculator
@@ -1,28 +1,55 @@
 #pragma once
 #include "tokenizer.hpp"
 
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
 #include <big_integer.hpp>
+#include <fixed_big_integer.hpp>
 
 namespace calc::calculator {
 
-class Calculator {
-private:
-    using Number = big_numbers::BigInteger;
-
+/// Evaluates expressions over Number, big_numbers::BigInteger or a fixed width
+/// big_numbers::FixedBigInteger of 128, 256 or 512 bits, the instantiations the
+/// library provides. Fixed width evaluation throws std::overflow_error when a number
+/// or a result is out of its range. The functions of calc::Function are computed on
+/// BigInteger and converted back
+template <class Number>
+class BasicCalculator {
 public:
-    Calculator(tokenizer::Tokenizer&&);
+    /// Calculator without input, expressions are given to Eval(std::string_view)
+    BasicCalculator();
+    BasicCalculator(tokenizer::Tokenizer&&);
 
-    Calculator& operator=(Calculator&& other);
+    BasicCalculator& operator=(BasicCalculator&& other);
 
+    /// Numbers of one evaluation come from an arena released when it ends, only the
+    /// result is allocated on the heap
     Number Eval();
+    /// Evaluates the expression instead of the rest of the current input, so one
+    /// calculator can go through many expressions. The text is read in place and
+    /// must hold one expression up to its end or first line end
+    Number Eval(std::string_view expression);
 
 private:
     tokenizer::Tokenizer tokenizer_;
+    /// Initial memory of the arena, reused by every evaluation
+    std::vector<std::byte> arena_buffer_;
+    /// Arena of the running evaluation
+    std::pmr::memory_resource* resource_{std::pmr::get_default_resource()};
+
+    void DetachArena();
 
     Number CalcMult();
+    Number CalcPower();
     Number CalcSum();
     Number CalcSubExpr();
+    Number CalcCall();
     Number GetNumber();
 };
 
+using Calculator = BasicCalculator<big_numbers::BigInteger>;
+
 }  // namespace calc::calculator
@@ -0,0 +1,220 @@
+#include <compiler.hpp>
+
+#include <string>
+#include <vector>
+
+#include "functions.hpp"
+
+namespace calc::compiler {
+
+namespace {
+
+using Register = Program::Register;
+
+/// Operand of a sum, negative ones are subtracted
+struct Term {
+    Register value;
+    bool negative;
+};
+
+// Both chains are emitted as balanced trees, neighbours combined in rounds. Factors
+// of similar sizes then meet in the fast multiplication, and independent halves of
+// a long chain can be computed in parallel
+Register MultiplyAll(Program& program, std::vector<Register>& factors) {
+    while (factors.size() > 1) {
+        std::size_t half = factors.size() / 2;
+        for (std::size_t idx = 0; idx < half; ++idx) {
+            factors[idx] =
+                program.AddOperation(OpCode::kMul, factors[2 * idx], factors[2 * idx + 1]);
+        }
+        if (factors.size() % 2 == 1) {
+            factors[half] = factors.back();
+            ++half;
+        }
+        factors.resize(half);
+    }
+    return factors.front();
+}
+
+// The first term is never negative, so the term a round starts with isn't either
+Register AddAll(Program& program, std::vector<Term>& terms) {
+    while (terms.size() > 1) {
+        std::size_t half = terms.size() / 2;
+        for (std::size_t idx = 0; idx < half; ++idx) {
+            Term lhs = terms[2 * idx];
+            Term rhs = terms[2 * idx + 1];
+            if (lhs.negative == rhs.negative) {
+                terms[idx] = {program.AddOperation(OpCode::kAdd, lhs.value, rhs.value),
+                              lhs.negative};
+            } else if (rhs.negative) {
+                terms[idx] = {program.AddOperation(OpCode::kSub, lhs.value, rhs.value), false};
+            } else {
+                terms[idx] = {program.AddOperation(OpCode::kSub, rhs.value, lhs.value), false};
+            }
+        }
+        if (terms.size() % 2 == 1) {
+            terms[half] = terms.back();
+            ++half;
+        }
+        terms.resize(half);
+    }
+    return terms.front().value;
+}
+
+OpCode FunctionCode(Function function) {
+    switch (function) {
+        case Function::kSqrt:
+            return OpCode::kSqrt;
+        case Function::kRoot:
+            return OpCode::kRoot;
+        case Function::kGcd:
+            return OpCode::kGcd;
+        case Function::kLcm:
+            return OpCode::kLcm;
+        case Function::kModInverse:
+            return OpCode::kModInverse;
+    }
+    throw std::logic_error("Compiler: unknown function");
+}
+
+}  // namespace
+
+Compiler::Compiler(tokenizer::Tokenizer&& tokenizer) : tokenizer_(std::move(tokenizer)) {
+}
+
+Compiler& Compiler::operator=(Compiler&& other) {
+    tokenizer_ = std::move(other.tokenizer_);
+    program_ = std::move(other.program_);
+    return *this;
+}
+
+Program Compiler::Compile() {
+    program_ = Program();
+    CompileSum();
+    return std::move(program_);
+}
+
+Program::Register Compiler::CompileMult() {
+    // Runs of * are split by / and %, which don't commute with them
+    std::vector<Register> factors = {CompilePower()};
+
+    while (auto op_ptr = tokenizer_.PeekIf<tokenizer::MulOpToken>()) {
+        tokenizer::MulOpToken op = *op_ptr;
+        tokenizer_.Next();
+        Register rhs = CompilePower();
+
+        if (op == tokenizer::MulOpToken::kMult) {
+            factors.push_back(rhs);
+        } else if (op == tokenizer::MulOpToken::kDiv) {
+            factors.assign(
+                1, program_.AddOperation(OpCode::kDiv, MultiplyAll(program_, factors), rhs));
+        } else if (op == tokenizer::MulOpToken::kModule) {
+            factors.assign(
+                1, program_.AddOperation(OpCode::kModule, MultiplyAll(program_, factors), rhs));
+        }
+    }
+
+    return MultiplyAll(program_, factors);
+}
+
+Program::Register Compiler::CompilePower() {
+    Register base = CompileNumber();
+    if (!tokenizer_.PeekIf<tokenizer::PowOpToken>()) {
+        return base;
+    }
+    tokenizer_.Next();
+    return program_.AddOperation(OpCode::kPow, base, CompilePower());
+}
+
+Program::Register Compiler::CompileSum() {
+    std::vector<Term> terms = {{CompileMult(), false}};
+
+    while (auto op_ptr = tokenizer_.PeekIf<tokenizer::AddOpToken>()) {
+        tokenizer::AddOpToken op = *op_ptr;
+        tokenizer_.Next();
+        Register rhs = CompileMult();
+
+        if (op == tokenizer::AddOpToken::kPlus) {
+            terms.push_back({rhs, false});
+        } else if (op == tokenizer::AddOpToken::kMinus) {
+            terms.push_back({rhs, true});
+        }
+    }
+
+    return AddAll(program_, terms);
+}
+
+Program::Register Compiler::CompileSubExpr() {
+    if (tokenizer_.IsEnd()) {
+        return program_.AddConstant(0);
+    }
+    auto bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>();
+    if (!bracket_ptr || *bracket_ptr != tokenizer::BracketToken::kOpen) {
+        throw std::runtime_error("Expected (");
+    }
+
+    tokenizer_.Next();
+    Register res = CompileSum();
+
+    bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>();
+    if (!bracket_ptr || *bracket_ptr != tokenizer::BracketToken::kClose) {
+        throw std::runtime_error("Expected )");
+    }
+    tokenizer_.Next();
+
+    return res;
+}
+
+// A name followed by ( calls a function, as in calculator::Calculator
+Program::Register Compiler::CompileCall() {
+    std::string name = std::get<tokenizer::IdentifierToken>(tokenizer_.Take()).name;
+    std::optional<Function> function = FindFunction(name);
+    if (!function) {
+        throw std::runtime_error("Unknown function '" + name + "'");
+    }
+    tokenizer_.Next();
+
+    Register args[2];
+    for (std::size_t idx = 0; idx < Arity(*function); ++idx) {
+        if (idx > 0) {
+            if (!tokenizer_.PeekIf<tokenizer::CommaToken>()) {
+                throw std::runtime_error("Expected ,");
+            }
+            tokenizer_.Next();
+        }
+        args[idx] = CompileSum();
+    }
+
+    auto bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>();
+    if (!bracket_ptr || *bracket_ptr != tokenizer::BracketToken::kClose) {
+        throw std::runtime_error("Expected )");
+    }
+    tokenizer_.Next();
+
+    Register rhs = Arity(*function) > 1 ? args[1] : args[0];
+    return program_.AddOperation(FunctionCode(*function), args[0], rhs);
+}
+
+Program::Register Compiler::CompileNumber() {
+    if (tokenizer_.IsEnd()) {
+        throw std::runtime_error("Expression ends unexpectedly. Number or ( is expected");
+    }
+    if (tokenizer_.PeekIf<tokenizer::IdentifierToken>()) {
+        auto bracket_ptr = tokenizer_.PeekIf<tokenizer::BracketToken>(1);
+        if (bracket_ptr && *bracket_ptr == tokenizer::BracketToken::kOpen) {
+            return CompileCall();
+        }
+    }
+    if (auto identifier_ptr = tokenizer_.PeekIf<tokenizer::IdentifierToken>()) {
+        Register res = program_.AddVariable(identifier_ptr->name);
+        tokenizer_.Next();
+        return res;
+    }
+    if (!tokenizer_.PeekIf<tokenizer::NumberToken>()) {
+        return CompileSubExpr();
+    }
+
+    return program_.AddConstant(std::get<tokenizer::NumberToken>(tokenizer_.Take()).value);
+}
+
+}  // namespace calc::compiler
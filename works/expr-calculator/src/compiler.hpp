@@ -0,0 +1,33 @@
+#pragma once
+#include "program.hpp"
+#include "tokenizer.hpp"
+
+namespace calc::compiler {
+
+/// Parses an expression with the grammar of calculator::Calculator extended by
+/// variables. Instead of computing it emits a Program that an Evaluator can run any
+/// number of times with different variable values
+class Compiler {
+private:
+    using Register = Program::Register;
+
+public:
+    Compiler(tokenizer::Tokenizer&&);
+
+    Compiler& operator=(Compiler&& other);
+
+    Program Compile();
+
+private:
+    tokenizer::Tokenizer tokenizer_;
+    Program program_;
+
+    Register CompileMult();
+    Register CompilePower();
+    Register CompileSum();
+    Register CompileSubExpr();
+    Register CompileCall();
+    Register CompileNumber();
+};
+
+}  // namespace calc::compiler
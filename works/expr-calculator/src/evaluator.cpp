@@ -0,0 +1,124 @@
+#include <evaluator.hpp>
+
+#include <stdexcept>
+
+namespace calc::compiler {
+
+void Evaluator::Prepare(const Program& program, std::size_t variables) {
+    if (program.Empty()) {
+        throw std::logic_error("Evaluator: empty program");
+    }
+    if (variables != program.Variables().size()) {
+        throw std::invalid_argument("Evaluator: expected values for " +
+                                    std::to_string(program.Variables().size()) + " variables");
+    }
+    if (registers_.size() < program.Size()) {
+        registers_.resize(program.Size());
+    }
+}
+
+const Evaluator::Number& Evaluator::Run(const Program& program) {
+    Prepare(program, 0);
+    return Execute(program, nullptr, 0, true);
+}
+
+const Evaluator::Number& Evaluator::Run(const Program& program,
+                                        const std::vector<Number>& values) {
+    Prepare(program, values.size());
+    // Every value is a column of one row
+    columns_.clear();
+    for (const Number& value : values) {
+        columns_.push_back(&value);
+    }
+    return Execute(program, columns_.data(), 0, true);
+}
+
+Evaluator::Column Evaluator::RunBatch(const Program& program, const std::vector<Column>& columns) {
+    Prepare(program, columns.size());
+    std::size_t rows = columns.empty() ? 1 : columns[0].size();
+    columns_.clear();
+    for (const Column& column : columns) {
+        if (column.size() != rows) {
+            throw std::invalid_argument("Evaluator: columns of different sizes");
+        }
+        columns_.push_back(column.data());
+    }
+
+    Column results;
+    results.reserve(rows);
+    for (std::size_t row = 0; row < rows; ++row) {
+        results.push_back(Execute(program, columns_.data(), row, row == 0));
+    }
+    return results;
+}
+
+const Evaluator::Number& Evaluator::Execute(const Program& program, const Number* const* columns,
+                                            std::size_t row, bool load_constants) {
+    const auto& code = program.Instructions();
+    for (std::size_t idx = 0; idx < code.size(); ++idx) {
+        const Instruction& instruction = code[idx];
+        Number& res = registers_[idx];
+        if (instruction.op == OpCode::kConst) {
+            if (load_constants) {
+                res = program.Constants()[instruction.lhs];
+            }
+            continue;
+        }
+        if (instruction.op == OpCode::kVariable) {
+            res = columns[instruction.lhs][row];
+            continue;
+        }
+
+        // Sums and differences are copied and accumulated into the cells res already
+        // has. The other operations build a new number, which is moved into res
+        const Number& lhs = registers_[instruction.lhs];
+        const Number& rhs = registers_[instruction.rhs];
+        switch (instruction.op) {
+            case OpCode::kAdd:
+                res = lhs;
+                res += rhs;
+                break;
+            case OpCode::kSub:
+                res = lhs;
+                res -= rhs;
+                break;
+            case OpCode::kMul:
+                res = lhs * rhs;
+                break;
+            case OpCode::kDiv:
+                res = lhs / rhs;
+                break;
+            case OpCode::kModule:
+                res = lhs % rhs;
+                break;
+            case OpCode::kSquare:
+                res = lhs.Square();
+                break;
+            case OpCode::kPow:
+                res = lhs.Pow(rhs);
+                break;
+            case OpCode::kSqrt:
+                res = lhs.Sqrt();
+                break;
+            case OpCode::kRoot:
+                res = lhs.Root(rhs);
+                break;
+            case OpCode::kGcd:
+                res = lhs.Gcd(rhs);
+                break;
+            case OpCode::kLcm:
+                res = lhs.Lcm(rhs);
+                break;
+            case OpCode::kModInverse:
+                res = lhs.ModInverse(rhs);
+                break;
+            case OpCode::kConst:
+            case OpCode::kVariable:
+                break;
+        }
+    }
+
+    return registers_[code.size() - 1];
+}
+
+}  // namespace calc::compiler
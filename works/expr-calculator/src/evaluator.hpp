@@ -0,0 +1,37 @@
+#pragma once
+#include "program.hpp"
+
+#include <vector>
+
+namespace calc::compiler {
+
+/// Runs compiled programs. The register file is kept between runs, so evaluating
+/// the same program again reuses the cells of the previous values
+class Evaluator {
+public:
+    using Number = Program::Number;
+    /// Values of one variable, one per row
+    using Column = std::vector<Number>;
+
+    /// Value of a program without variables. Stays valid until the next Run
+    const Number& Run(const Program&);
+    /// values[i] is bound to program.Variables()[i]
+    const Number& Run(const Program&, const std::vector<Number>& values);
+
+    /// Runs the program once per row: row r binds columns[i][r] to
+    /// program.Variables()[i]. All columns have the same size, a program without
+    /// variables runs once
+    Column RunBatch(const Program&, const std::vector<Column>& columns);
+
+private:
+    void Prepare(const Program&, std::size_t variables);
+    /// Executes the program with variable i bound to columns[i][row]. Constants are
+    /// loaded only when load_constants is set, otherwise the registers still hold them
+    const Number& Execute(const Program&, const Number* const* columns, std::size_t row,
+                          bool load_constants);
+
+    std::vector<Number> registers_;
+    std::vector<const Number*> columns_;
+};
+
+}  // namespace calc::compiler
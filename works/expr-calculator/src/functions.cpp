@@ -0,0 +1,57 @@
+#include "functions.hpp"
+
+#include <stdexcept>
+
+namespace calc {
+
+namespace {
+
+struct FunctionInfo {
+    std::string_view name;
+    Function function;
+    std::size_t arity;
+};
+
+constexpr FunctionInfo kFunctions[] = {{"sqrt", Function::kSqrt, 1},
+                                       {"root", Function::kRoot, 2},
+                                       {"gcd", Function::kGcd, 2},
+                                       {"lcm", Function::kLcm, 2},
+                                       {"modinv", Function::kModInverse, 2}};
+
+}  // namespace
+
+std::optional<Function> FindFunction(std::string_view name) {
+    for (const FunctionInfo& info : kFunctions) {
+        if (info.name == name) {
+            return info.function;
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t Arity(Function function) {
+    for (const FunctionInfo& info : kFunctions) {
+        if (info.function == function) {
+            return info.arity;
+        }
+    }
+    throw std::logic_error("Arity: unknown function");
+}
+
+big_numbers::BigInteger Call(Function function, const big_numbers::BigInteger* args) {
+    switch (function) {
+        case Function::kSqrt:
+            return args[0].Sqrt();
+        case Function::kRoot:
+            return args[0].Root(args[1]);
+        case Function::kGcd:
+            return args[0].Gcd(args[1]);
+        case Function::kLcm:
+            return args[0].Lcm(args[1]);
+        case Function::kModInverse:
+            return args[0].ModInverse(args[1]);
+    }
+    throw std::logic_error("Call: unknown function");
+}
+
+}  // namespace calc
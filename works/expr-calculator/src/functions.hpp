@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include <big_integer.hpp>
+
+namespace calc {
+
+/// Functions of the grammar, an identifier followed by ( calls one:
+/// sqrt(x), root(x, n), gcd(a, b), lcm(a, b) and modinv(a, m)
+enum class Function { kSqrt, kRoot, kGcd, kLcm, kModInverse };
+
+/// Function called name, std::nullopt for other names
+std::optional<Function> FindFunction(std::string_view name);
+/// Arguments the function takes, one or two
+std::size_t Arity(Function);
+/// Value of the function for the arguments args[0], ..., args[Arity(function) - 1]
+big_numbers::BigInteger Call(Function, const big_numbers::BigInteger* args);
+
+}  // namespace calc
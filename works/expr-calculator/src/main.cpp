@@ -1,11 +1,87 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include "batch.hpp"
 #include "calculator.hpp"
+#include "mapped_file.hpp"
 
-int main() {
+namespace {
 
+void PrintUsage(const char* name) {
+    std::cerr << "usage: " << name << " [--bits 128|256|512]\n"
+              << "       " << name << " --batch [--threads N] [FILE]\n"
+              << "Without --batch evaluates one expression from stdin, in fixed width numbers\n"
+              << "of the given bits if asked, with it every line of FILE or stdin, using N\n"
+              << "threads\n";
+}
+
+template <class Number>
+void EvalInput() {
     calc::tokenizer::Tokenizer tokenizer(&std::cin);
-    calc::calculator::Calculator calc(std::move(tokenizer));
+    calc::calculator::BasicCalculator<Number> calc(std::move(tokenizer));
 
     std::cout << std::endl << "answer is " << calc.Eval() << std::endl;
 }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool batch = false;
+    unsigned long bits = 0;
+    calc::BatchOptions options;
+    bool threads = false;
+    const char* path = nullptr;
+    for (int idx = 1; idx < argc; ++idx) {
+        if (std::strcmp(argv[idx], "--batch") == 0) {
+            batch = true;
+        } else if (std::strcmp(argv[idx], "--threads") == 0 && idx + 1 < argc &&
+                   std::isdigit(static_cast<unsigned char>(argv[idx + 1][0]))) {
+            options.threads = std::strtoul(argv[++idx], nullptr, 10);
+            threads = true;
+        } else if (std::strcmp(argv[idx], "--bits") == 0 && idx + 1 < argc) {
+            bits = std::strtoul(argv[++idx], nullptr, 10);
+        } else if (argv[idx][0] != '-' && !path) {
+            path = argv[idx];
+        } else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (bits != 0 && (batch || (bits != 128 && bits != 256 && bits != 512))) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    // A file or threads without --batch would be ignored while stdin is read
+    if (!batch && (path || threads)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    if (!batch) {
+        if (bits == 128) {
+            EvalInput<big_numbers::FixedBigInteger<128>>();
+        } else if (bits == 256) {
+            EvalInput<big_numbers::FixedBigInteger<256>>();
+        } else if (bits == 512) {
+            EvalInput<big_numbers::FixedBigInteger<512>>();
+        } else {
+            EvalInput<big_numbers::BigInteger>();
+        }
+        return 0;
+    }
+
+    std::ios::sync_with_stdio(false);
+    try {
+        if (path) {
+            calc::MappedFile file(path);
+            calc::RunBatch(file.View(), std::cout, options);
+        } else {
+            calc::RunBatch(std::cin, std::cout, options);
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+}
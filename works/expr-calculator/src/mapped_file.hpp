@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace calc {
+
+/// Read-only memory mapping of a whole file. The contents are paged in by the
+/// kernel on first access, so huge inputs are never copied into a buffer
+class MappedFile {
+public:
+    /// Throws std::system_error when the file can't be opened or mapped
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(MappedFile&&);
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(MappedFile&&);
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    std::string_view View() const {
+        return {data_, size_};
+    }
+
+private:
+    void Unmap();
+
+    const char* data_{nullptr};
+    std::size_t size_{0};
+};
+
+}  // namespace calc
@@ -0,0 +1,283 @@
+#include <optimizer.hpp>
+
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace calc::compiler {
+
+namespace {
+
+using Number = Program::Number;
+using Register = Program::Register;
+
+Number Apply(OpCode op, const Number& lhs, const Number& rhs) {
+    switch (op) {
+        case OpCode::kAdd:
+            return lhs + rhs;
+        case OpCode::kSub:
+            return lhs - rhs;
+        case OpCode::kMul:
+            return lhs * rhs;
+        case OpCode::kDiv:
+            return lhs / rhs;
+        case OpCode::kModule:
+            return lhs % rhs;
+        case OpCode::kSquare:
+            return lhs * lhs;
+        case OpCode::kPow:
+            return lhs.Pow(rhs);
+        case OpCode::kSqrt:
+            return lhs.Sqrt();
+        case OpCode::kRoot:
+            return lhs.Root(rhs);
+        case OpCode::kGcd:
+            return lhs.Gcd(rhs);
+        case OpCode::kLcm:
+            return lhs.Lcm(rhs);
+        case OpCode::kModInverse:
+            return lhs.ModInverse(rhs);
+        default:
+            throw std::logic_error("Optimize: not an operation");
+    }
+}
+
+/// Whether op can throw for operands of these values, nullptr for an unknown value
+bool MayFail(OpCode op, const Number* lhs, const Number* rhs) {
+    switch (op) {
+        case OpCode::kDiv:
+        case OpCode::kModule:
+            return !rhs || *rhs == 0;
+        case OpCode::kPow:
+            return !rhs || *rhs < 0;
+        case OpCode::kSqrt:
+            return !lhs || *lhs < 0;
+        case OpCode::kRoot:
+            return !rhs || *rhs < 1 || ((!lhs || *lhs < 0) && *rhs % 2 == 0);
+        case OpCode::kModInverse:
+            return !lhs || !rhs || *rhs == 0 || !(lhs->Gcd(*rhs) == 1);
+        default:
+            return false;
+    }
+}
+
+bool IsCommutative(OpCode op) {
+    return op == OpCode::kAdd || op == OpCode::kMul || op == OpCode::kGcd || op == OpCode::kLcm;
+}
+
+// Rebuilds a program node by node. Nodes are interned by their contents, so a node
+// equal to an existing one is never created twice, and constants are known while
+// rewriting
+class Builder {
+public:
+    explicit Builder(const Program& source) : source_(source) {
+    }
+
+    Register Constant(const Number& value) {
+        auto it = constant_nodes_.find(value);
+        if (it != constant_nodes_.end()) {
+            return it->second;
+        }
+        Register node = Append({OpCode::kConst, static_cast<Register>(constants_.size()), 0},
+                               false);
+        constants_.push_back(value);
+        constant_nodes_.emplace(value, node);
+        return node;
+    }
+
+    Register Variable(Register variable) {
+        return Intern({OpCode::kVariable, variable, 0}, false);
+    }
+
+    Register Operation(OpCode op, Register lhs, Register rhs) {
+        if (op == OpCode::kMul && lhs == rhs) {
+            op = OpCode::kSquare;
+        }
+        if (IsCommutative(op) && lhs > rhs) {
+            std::swap(lhs, rhs);
+        }
+
+        const Number* lhs_value = Value(lhs);
+        const Number* rhs_value = Value(rhs);
+        bool fails = MayFail(op, lhs_value, rhs_value);
+        if (lhs_value && rhs_value && !fails) {
+            // A power too large to store is only known once Pow tries it
+            try {
+                return Constant(Apply(op, *lhs_value, *rhs_value));
+            } catch (const std::length_error&) {
+                fails = true;
+            }
+        }
+
+        if (auto simplified = Simplify(op, lhs, rhs, lhs_value, rhs_value)) {
+            return *simplified;
+        }
+
+        bool may_throw = may_throw_[lhs] || may_throw_[rhs] || fails;
+        return Intern({op, lhs, rhs}, may_throw);
+    }
+
+    /// Live nodes of result in the order of creation, emitted into a new program
+    Program Emit(Register result) const {
+        std::vector<bool> live(nodes_.size(), false);
+        live[result] = true;
+        for (std::size_t idx = result + 1; idx-- > 0;) {
+            const Instruction& node = nodes_[idx];
+            if (live[idx] && node.op != OpCode::kConst && node.op != OpCode::kVariable) {
+                live[node.lhs] = true;
+                live[node.rhs] = true;
+            }
+        }
+
+        Program program;
+        for (const std::string& name : source_.Variables()) {
+            program.DeclareVariable(name);
+        }
+        std::vector<Register> registers(nodes_.size());
+        for (std::size_t idx = 0; idx <= result; ++idx) {
+            if (!live[idx]) {
+                continue;
+            }
+            const Instruction& node = nodes_[idx];
+            if (node.op == OpCode::kConst) {
+                registers[idx] = program.AddConstant(constants_[node.lhs]);
+            } else if (node.op == OpCode::kVariable) {
+                registers[idx] = program.AddVariable(source_.Variables()[node.lhs]);
+            } else {
+                registers[idx] =
+                    program.AddOperation(node.op, registers[node.lhs], registers[node.rhs]);
+            }
+        }
+        return program;
+    }
+
+private:
+    const Number* Value(Register node) const {
+        return nodes_[node].op == OpCode::kConst ? &constants_[nodes_[node].lhs] : nullptr;
+    }
+
+    // Identities. An operand may only be dropped when computing it can't throw
+    std::optional<Register> Simplify(OpCode op, Register lhs, Register rhs,
+                                     const Number* lhs_value, const Number* rhs_value) {
+        auto is = [](const Number* value, int expected) { return value && *value == expected; };
+
+        switch (op) {
+            case OpCode::kAdd:
+                if (is(lhs_value, 0)) {
+                    return rhs;
+                }
+                if (is(rhs_value, 0)) {
+                    return lhs;
+                }
+                break;
+            case OpCode::kSub:
+                if (is(rhs_value, 0)) {
+                    return lhs;
+                }
+                if (lhs == rhs && !may_throw_[lhs]) {
+                    return Constant(0);
+                }
+                break;
+            case OpCode::kMul:
+                if (is(lhs_value, 1)) {
+                    return rhs;
+                }
+                if (is(rhs_value, 1)) {
+                    return lhs;
+                }
+                if ((is(lhs_value, 0) && !may_throw_[rhs]) ||
+                    (is(rhs_value, 0) && !may_throw_[lhs])) {
+                    return Constant(0);
+                }
+                break;
+            case OpCode::kDiv:
+                if (is(rhs_value, 1)) {
+                    return lhs;
+                }
+                break;
+            case OpCode::kModule:
+                if ((is(rhs_value, 1) || is(rhs_value, -1)) && !may_throw_[lhs]) {
+                    return Constant(0);
+                }
+                break;
+            case OpCode::kPow:
+                if (is(rhs_value, 1)) {
+                    return lhs;
+                }
+                if (is(rhs_value, 2)) {
+                    return Operation(OpCode::kMul, lhs, lhs);
+                }
+                if (is(rhs_value, 0) && !may_throw_[lhs]) {
+                    return Constant(1);
+                }
+                break;
+            default:
+                break;
+        }
+        return std::nullopt;
+    }
+
+    Register Intern(Instruction node, bool may_throw) {
+        auto key = std::make_tuple(node.op, node.lhs, node.rhs);
+        auto it = nodes_by_key_.find(key);
+        if (it != nodes_by_key_.end()) {
+            return it->second;
+        }
+        Register res = Append(node, may_throw);
+        nodes_by_key_.emplace(key, res);
+        return res;
+    }
+
+    Register Append(Instruction node, bool may_throw) {
+        nodes_.push_back(node);
+        may_throw_.push_back(may_throw);
+        return static_cast<Register>(nodes_.size() - 1);
+    }
+
+    const Program& source_;
+    std::vector<Instruction> nodes_;
+    /// Whether computing the node can throw (a division by a zero or by a variable, a
+    /// root of a negative number, ...)
+    std::vector<bool> may_throw_;
+    std::vector<Number> constants_;
+    std::map<Number, Register> constant_nodes_;
+    std::map<std::tuple<OpCode, Register, Register>, Register> nodes_by_key_;
+};
+
+}  // namespace
+
+Program Optimize(const Program& program) {
+    if (program.Empty()) {
+        return program;
+    }
+
+    Builder builder(program);
+    // Node of every register of the source program
+    std::vector<Register> nodes;
+    nodes.reserve(program.Size());
+    for (const Instruction& instruction : program.Instructions()) {
+        switch (instruction.op) {
+            case OpCode::kConst:
+                nodes.push_back(builder.Constant(program.Constants()[instruction.lhs]));
+                break;
+            case OpCode::kVariable:
+                nodes.push_back(builder.Variable(instruction.lhs));
+                break;
+            case OpCode::kSquare: {
+                Register node = nodes[instruction.lhs];
+                nodes.push_back(builder.Operation(OpCode::kMul, node, node));
+                break;
+            }
+            default:
+                nodes.push_back(builder.Operation(instruction.op, nodes[instruction.lhs],
+                                                  nodes[instruction.rhs]));
+                break;
+        }
+    }
+    return builder.Emit(nodes.back());
+}
+
+}  // namespace calc::compiler
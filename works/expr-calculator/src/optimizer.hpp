@@ -0,0 +1,19 @@
+#pragma once
+#include "program.hpp"
+
+namespace calc::compiler {
+
+/// Equivalent program that does only the work depending on the variables:
+///   - operations on constants are computed once here, except the ones failing on
+///     them, which are left to fail at run time: a division by zero, a negative or
+///     too large exponent, sqrt of a negative number, root of a degree below 1 or an
+///     even root of a negative number and modinv without an inverse,
+///   - x + 0, x - 0, x * 1, x / 1, x ^ 1 become x, x * 0, x % 1 and x - x become 0
+///     and x ^ 0 becomes 1 when computing x can't fail,
+///   - equal subexpressions are computed once, x + y and y + x count as equal,
+///   - x * x and x ^ 2 become a squaring,
+///   - instructions the result doesn't depend on are dropped.
+/// Variables() of the result are the same and in the same order
+Program Optimize(const Program&);
+
+}  // namespace calc::compiler
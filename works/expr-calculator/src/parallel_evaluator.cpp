@@ -0,0 +1,319 @@
+#include <parallel_evaluator.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace calc::compiler {
+
+namespace {
+
+using Number = Program::Number;
+using Register = Program::Register;
+
+/// State of one run of a program. Register i is written only by the thread
+/// computing instruction i, its users read it after their operand counter drops to
+/// zero, which orders the write before the reads
+class Evaluation {
+public:
+    Evaluation(const Program& program, const Number* values, big_numbers::ThreadPool& pool,
+               std::size_t min_cost)
+        : program_(program),
+          values_(values),
+          pool_(pool),
+          min_cost_(min_cost),
+          registers_(program.Size()),
+          waiting_(std::make_unique<std::atomic<std::uint32_t>[]>(program.Size())),
+          first_user_(program.Size() + 1, 0) {
+        Link();
+        EstimateCosts();
+    }
+
+    Number Run() {
+        // The calling thread counts as one running task until every leaf is loaded.
+        // It hands out all the expensive work, so the leaves after it aren't delayed
+        running_.store(1);
+        const auto& code = program_.Instructions();
+        for (std::size_t idx = 0; idx < code.size(); ++idx) {
+            if (code[idx].op == OpCode::kConst || code[idx].op == OpCode::kVariable) {
+                Process(static_cast<Register>(idx), false);
+            }
+        }
+        Finish();
+        pool_.Wait([this] { return running_.load() == 0; });
+
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return std::move(registers_.back());
+    }
+
+private:
+    /// Operands of an operation without repeats, kSquare and x op x read one register
+    std::pair<Register, std::size_t> Operands(const Instruction& instruction) const {
+        if (instruction.op == OpCode::kConst || instruction.op == OpCode::kVariable) {
+            return {0, 0};
+        }
+        if (instruction.op == OpCode::kSquare || instruction.lhs == instruction.rhs) {
+            return {instruction.lhs, 1};
+        }
+        return {instruction.lhs, 2};
+    }
+
+    /// Builds the users of every register in the layout of a CSR matrix
+    void Link() {
+        const auto& code = program_.Instructions();
+        for (const Instruction& instruction : code) {
+            auto [lhs, count] = Operands(instruction);
+            if (count > 0) {
+                ++first_user_[lhs + 1];
+            }
+            if (count > 1) {
+                ++first_user_[instruction.rhs + 1];
+            }
+        }
+        for (std::size_t idx = 0; idx < code.size(); ++idx) {
+            first_user_[idx + 1] += first_user_[idx];
+        }
+
+        users_.resize(first_user_.back());
+        std::vector<std::size_t> filled(first_user_.begin(), first_user_.end() - 1);
+        for (std::size_t idx = 0; idx < code.size(); ++idx) {
+            auto [lhs, count] = Operands(code[idx]);
+            waiting_[idx].store(static_cast<std::uint32_t>(count));
+            if (count > 0) {
+                users_[filled[lhs]++] = static_cast<Register>(idx);
+            }
+            if (count > 1) {
+                users_[filled[code[idx].rhs]++] = static_cast<Register>(idx);
+            }
+        }
+    }
+
+    /// Cell operations of every instruction, from the sizes its operands will have
+    void EstimateCosts() {
+        const auto& code = program_.Instructions();
+        std::vector<std::size_t> cells(code.size());
+        costs_.resize(code.size());
+        for (std::size_t idx = 0; idx < code.size(); ++idx) {
+            const Instruction& instruction = code[idx];
+            if (instruction.op == OpCode::kConst) {
+                cells[idx] = program_.Constants()[instruction.lhs].Cells();
+                costs_[idx] = cells[idx];
+                continue;
+            }
+            if (instruction.op == OpCode::kVariable) {
+                cells[idx] = values_[instruction.lhs].Cells();
+                costs_[idx] = cells[idx];
+                continue;
+            }
+
+            std::size_t lhs = cells[instruction.lhs];
+            std::size_t rhs = instruction.op == OpCode::kSquare ? lhs : cells[instruction.rhs];
+            switch (instruction.op) {
+                case OpCode::kAdd:
+                case OpCode::kSub:
+                    cells[idx] = std::max(lhs, rhs) + 1;
+                    costs_[idx] = cells[idx];
+                    break;
+                case OpCode::kMul:
+                case OpCode::kSquare:
+                    cells[idx] = lhs + rhs;
+                    costs_[idx] = lhs * rhs;
+                    break;
+                case OpCode::kDiv:
+                case OpCode::kModule:
+                    cells[idx] = instruction.op == OpCode::kDiv
+                                     ? (lhs > rhs ? lhs - rhs + 1 : 1)
+                                     : rhs;
+                    costs_[idx] = lhs + (lhs > rhs ? (lhs - rhs + 1) * rhs : 0);
+                    break;
+                case OpCode::kPow:
+                    // The size depends on the value of the exponent, not known here. The
+                    // power is taken for a square, but always run as a task of its own
+                    cells[idx] = 2 * lhs;
+                    costs_[idx] = std::max(lhs * lhs, min_cost_);
+                    break;
+                case OpCode::kSqrt:
+                case OpCode::kRoot:
+                    // About a division of the number by its root
+                    cells[idx] = lhs / 2 + 1;
+                    costs_[idx] = lhs * lhs;
+                    break;
+                case OpCode::kGcd:
+                case OpCode::kLcm:
+                case OpCode::kModInverse:
+                    // Lehmer's algorithm, linear work for every cell it removes
+                    cells[idx] = instruction.op == OpCode::kLcm ? lhs + rhs : std::min(lhs, rhs);
+                    costs_[idx] = lhs * rhs;
+                    break;
+                case OpCode::kConst:
+                case OpCode::kVariable:
+                    break;
+            }
+        }
+    }
+
+    void Compute(Register idx) {
+        const Instruction& instruction = program_.Instructions()[idx];
+        Number& res = registers_[idx];
+        switch (instruction.op) {
+            case OpCode::kConst:
+                res = program_.Constants()[instruction.lhs];
+                break;
+            case OpCode::kVariable:
+                res = values_[instruction.lhs];
+                break;
+            case OpCode::kAdd:
+                res = registers_[instruction.lhs] + registers_[instruction.rhs];
+                break;
+            case OpCode::kSub:
+                res = registers_[instruction.lhs] - registers_[instruction.rhs];
+                break;
+            case OpCode::kMul:
+                res = registers_[instruction.lhs] * registers_[instruction.rhs];
+                break;
+            case OpCode::kDiv:
+                res = registers_[instruction.lhs] / registers_[instruction.rhs];
+                break;
+            case OpCode::kModule:
+                res = registers_[instruction.lhs] % registers_[instruction.rhs];
+                break;
+            case OpCode::kSquare:
+                res = registers_[instruction.lhs].Square();
+                break;
+            case OpCode::kPow:
+                res = registers_[instruction.lhs].Pow(registers_[instruction.rhs]);
+                break;
+            case OpCode::kSqrt:
+                res = registers_[instruction.lhs].Sqrt();
+                break;
+            case OpCode::kRoot:
+                res = registers_[instruction.lhs].Root(registers_[instruction.rhs]);
+                break;
+            case OpCode::kGcd:
+                res = registers_[instruction.lhs].Gcd(registers_[instruction.rhs]);
+                break;
+            case OpCode::kLcm:
+                res = registers_[instruction.lhs].Lcm(registers_[instruction.rhs]);
+                break;
+            case OpCode::kModInverse:
+                res = registers_[instruction.lhs].ModInverse(registers_[instruction.rhs]);
+                break;
+        }
+    }
+
+    /// Computes the instruction and then the users it makes ready. Cheap users stay
+    /// on this thread, and so does one expensive user with keep_expensive, other
+    /// expensive users become tasks
+    void Process(Register first, bool keep_expensive) {
+        std::vector<Register> stack = {first};
+        while (!stack.empty()) {
+            Register idx = stack.back();
+            stack.pop_back();
+            if (failed_.load()) {
+                continue;
+            }
+            try {
+                Compute(idx);
+            } catch (...) {
+                Fail(std::current_exception());
+                continue;
+            }
+
+            bool kept = !keep_expensive;
+            for (std::size_t pos = first_user_[idx]; pos < first_user_[idx + 1]; ++pos) {
+                Register user = users_[pos];
+                if (waiting_[user].fetch_sub(1) != 1) {
+                    continue;
+                }
+                if (costs_[user] < min_cost_ || !kept) {
+                    kept = kept || costs_[user] >= min_cost_;
+                    stack.push_back(user);
+                } else {
+                    Spawn(user);
+                }
+            }
+        }
+    }
+
+    void Spawn(Register idx) {
+        running_.fetch_add(1);
+        pool_.Submit([this, idx] {
+            Process(idx, true);
+            Finish();
+        });
+    }
+
+    void Finish() {
+        // Nothing of *this may be touched after the last task is done
+        big_numbers::ThreadPool& pool = pool_;
+        if (running_.fetch_sub(1) == 1) {
+            pool.Notify();
+        }
+    }
+
+    void Fail(std::exception_ptr error) {
+        std::lock_guard lock(error_mutex_);
+        if (!error_) {
+            error_ = std::move(error);
+            failed_.store(true);
+        }
+    }
+
+    const Program& program_;
+    const Number* values_;
+    big_numbers::ThreadPool& pool_;
+    std::size_t min_cost_;
+
+    std::vector<Number> registers_;
+    /// Operands of every instruction not computed yet
+    std::unique_ptr<std::atomic<std::uint32_t>[]> waiting_;
+    /// Users of register i are users_[first_user_[i]..first_user_[i + 1])
+    std::vector<std::size_t> first_user_;
+    std::vector<Register> users_;
+    std::vector<std::size_t> costs_;
+
+    /// Tasks started and not finished yet
+    std::atomic<std::size_t> running_{0};
+    std::atomic<bool> failed_{false};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+std::size_t PoolSize(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return threads - 1;
+}
+
+}  // namespace
+
+ParallelEvaluator::ParallelEvaluator(ParallelOptions options)
+    : min_cost_(options.min_cost), pool_(PoolSize(options.threads)) {
+}
+
+ParallelEvaluator::Number ParallelEvaluator::Run(const Program& program) {
+    return Run(program, {});
+}
+
+ParallelEvaluator::Number ParallelEvaluator::Run(const Program& program,
+                                                 const std::vector<Number>& values) {
+    if (program.Empty()) {
+        throw std::logic_error("Evaluator: empty program");
+    }
+    if (values.size() != program.Variables().size()) {
+        throw std::invalid_argument("Evaluator: expected values for " +
+                                    std::to_string(program.Variables().size()) + " variables");
+    }
+    return Evaluation(program, values.data(), pool_, min_cost_).Run();
+}
+
+}  // namespace calc::compiler
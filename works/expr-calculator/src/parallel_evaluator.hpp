@@ -0,0 +1,42 @@
+#pragma once
+#include "program.hpp"
+#include <thread_pool.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace calc::compiler {
+
+struct ParallelOptions {
+    /// Threads computing a program, the calling one included. 0 takes one per core
+    std::size_t threads = 0;
+    /// Instructions estimated to take fewer cell operations run right away on the
+    /// thread that computed their last operand instead of becoming a task
+    std::size_t min_cost = 1 << 12;
+};
+
+/// Runs compiled programs on several threads. An instruction is started as soon as
+/// all of its operands are computed, so independent subexpressions, like the terms
+/// of a long sum of products, are computed at the same time
+class ParallelEvaluator {
+public:
+    using Number = Program::Number;
+
+    explicit ParallelEvaluator(ParallelOptions options = {});
+
+    /// Threads computing a program, the calling one included
+    std::size_t Threads() const {
+        return pool_.Size() + 1;
+    }
+
+    /// Value of a program without variables
+    Number Run(const Program&);
+    /// values[i] is bound to program.Variables()[i]
+    Number Run(const Program&, const std::vector<Number>& values);
+
+private:
+    std::size_t min_cost_;
+    big_numbers::ThreadPool pool_;
+};
+
+}  // namespace calc::compiler
@@ -0,0 +1,48 @@
+#include "program.hpp"
+
+#include <stdexcept>
+
+namespace calc::compiler {
+
+Program::Register Program::AddConstant(Number value) {
+    constants_.push_back(std::move(value));
+    code_.push_back({OpCode::kConst, static_cast<Register>(constants_.size() - 1), 0});
+    return static_cast<Register>(code_.size() - 1);
+}
+
+Program::Register Program::AddVariable(std::string_view name) {
+    DeclareVariable(name);
+    std::size_t idx = *VariableIndex(name);
+    if (variable_registers_[idx] == kNoRegister) {
+        code_.push_back({OpCode::kVariable, static_cast<Register>(idx), 0});
+        variable_registers_[idx] = static_cast<Register>(code_.size() - 1);
+    }
+    return variable_registers_[idx];
+}
+
+void Program::DeclareVariable(std::string_view name) {
+    if (!VariableIndex(name)) {
+        variables_.emplace_back(name);
+        variable_registers_.push_back(kNoRegister);
+    }
+}
+
+std::optional<std::size_t> Program::VariableIndex(std::string_view name) const {
+    for (std::size_t idx = 0; idx < variables_.size(); ++idx) {
+        if (variables_[idx] == name) {
+            return idx;
+        }
+    }
+    return std::nullopt;
+}
+
+Program::Register Program::AddOperation(OpCode op, Register lhs, Register rhs) {
+    if (op == OpCode::kConst || op == OpCode::kVariable || lhs >= code_.size() ||
+        rhs >= code_.size()) {
+        throw std::logic_error("Program: operands must be earlier registers");
+    }
+    code_.push_back({op, lhs, rhs});
+    return static_cast<Register>(code_.size() - 1);
+}
+
+}  // namespace calc::compiler
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <big_integer.hpp>
+
+namespace calc::compiler {
+
+enum class OpCode : std::uint8_t {
+    kConst,
+    kVariable,
+    kAdd,
+    kSub,
+    kMul,
+    kDiv,
+    kModule,
+    kSquare,
+    kPow,
+    // The functions of calc::Function
+    kSqrt,
+    kRoot,
+    kGcd,
+    kLcm,
+    kModInverse
+};
+
+/// Instruction i of a program writes register i. For kConst lhs is an index into the
+/// constants, for kVariable an index into the variables, otherwise lhs and rhs are
+/// registers of earlier instructions (kSquare and kSqrt read only lhs, rhs repeats it)
+struct Instruction {
+    OpCode op;
+    std::uint32_t lhs;
+    std::uint32_t rhs;
+};
+
+/// Flat form of an expression: operands always come before the instructions using
+/// them and the value of the expression ends up in the last register
+class Program {
+public:
+    using Number = big_numbers::BigInteger;
+    using Register = std::uint32_t;
+
+    /// Appends a load of the constant, returns its register
+    Register AddConstant(Number);
+    /// Register holding the variable, the first use of a name appends its load
+    Register AddVariable(std::string_view name);
+    /// Adds the name to Variables() without loading it, so it keeps its place in
+    /// the binding order even when nothing reads it
+    void DeclareVariable(std::string_view name);
+    /// Appends lhs op rhs, returns its register
+    Register AddOperation(OpCode, Register lhs, Register rhs);
+
+    const std::vector<Instruction>& Instructions() const {
+        return code_;
+    }
+    const std::vector<Number>& Constants() const {
+        return constants_;
+    }
+    /// Variable names in order of first appearance, values are bound in this order
+    const std::vector<std::string>& Variables() const {
+        return variables_;
+    }
+    std::optional<std::size_t> VariableIndex(std::string_view name) const;
+
+    /// Registers needed to run the program
+    std::size_t Size() const {
+        return code_.size();
+    }
+    bool Empty() const {
+        return code_.empty();
+    }
+
+private:
+    static constexpr Register kNoRegister = ~Register{0};
+
+    std::vector<Instruction> code_;
+    std::vector<Number> constants_;
+    std::vector<std::string> variables_;
+    /// Register loading each variable, kNoRegister while it isn't loaded
+    std::vector<Register> variable_registers_;
+};
+
+}  // namespace calc::compiler
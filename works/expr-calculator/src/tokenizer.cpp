@@ -1,30 +1,58 @@
 #include "tokenizer.hpp"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include <digits.hpp>
 
 namespace calc::tokenizer {
 
 namespace {
 
-int ToDigit(char c) {
-    return c - '0';
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool IsIdentifierStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool IsIdentifierChar(char c) {
+    return IsIdentifierStart(c) || IsDigit(c);
 }
 
 }  // namespace
 
 Tokenizer::Tokenizer(std::istream* input) : input_(input) {
-    Next();
+    Fill(0);
 }
 
 Tokenizer::Tokenizer(std::unique_ptr<std::istream>&& input)
     : u_ptr_(std::move(input)), input_(u_ptr_.get()) {
-    Next();
+    Fill(0);
+}
+
+Tokenizer::Tokenizer(std::string_view input) : pos_(input.data()), end_(pos_ + input.size()) {
+    Fill(0);
+}
+
+Tokenizer::Tokenizer(MappedFile&& file) : file_(std::make_unique<MappedFile>(std::move(file))) {
+    pos_ = file_->View().data();
+    end_ = pos_ + file_->View().size();
+    Fill(0);
 }
 
 Tokenizer::Tokenizer(Tokenizer&& other)
     : u_ptr_(std::move(other.u_ptr_)),
       input_(u_ptr_ ? u_ptr_.get() : other.input_),
-      cur_token_(other.cur_token_),
-      is_end_(other.is_end_) {
+      file_(std::move(other.file_)),
+      pos_(std::exchange(other.pos_, nullptr)),
+      end_(std::exchange(other.end_, nullptr)),
+      resource_(other.resource_),
+      ring_(std::move(other.ring_)),
+      head_(std::exchange(other.head_, 0)),
+      count_(std::exchange(other.count_, 0)) {
     other.input_ = nullptr;
     other.u_ptr_ = nullptr;
 }
@@ -34,8 +62,13 @@ Tokenizer& Tokenizer::operator=(Tokenizer&& other) {
     input_ = u_ptr_ ? u_ptr_.get() : other.input_;
     other.input_ = nullptr;
     other.u_ptr_ = nullptr;
-    cur_token_ = other.cur_token_;
-    is_end_ = other.is_end_;
+    file_ = std::move(other.file_);
+    pos_ = std::exchange(other.pos_, nullptr);
+    end_ = std::exchange(other.end_, nullptr);
+    resource_ = other.resource_;
+    ring_ = std::move(other.ring_);
+    head_ = std::exchange(other.head_, 0);
+    count_ = std::exchange(other.count_, 0);
 
     return *this;
 }
@@ -50,46 +83,167 @@ bool Tokenizer::StreamEnd() {
     return input_->eof() || input_->peek() == '\n';
 }
 
-bool Tokenizer::IsEnd() {
-    return is_end_;
+bool Tokenizer::IsEnd(std::size_t ahead) {
+    Fill(ahead);
+    // Nothing is read after the end
+    return ahead >= count_ || At(ahead).end;
 }
 
 void Tokenizer::Next() {
+    Fill(0);
+    if (!At(0).end) {
+        head_ = (head_ + 1) & (ring_.size() - 1);
+        --count_;
+        Fill(0);
+    }
+}
+
+const Token& Tokenizer::GetToken() {
+    return Peek(0);
+}
+
+const Token& Tokenizer::Peek(std::size_t ahead) {
+    if (IsEnd(ahead)) {
+        throw std::logic_error("Tokenizer: no token past the end of the input");
+    }
+    return At(ahead).token;
+}
+
+Token Tokenizer::Take() {
+    if (IsEnd()) {
+        throw std::logic_error("Tokenizer: no token past the end of the input");
+    }
+    Token token = std::move(At(0).token);
+    Next();
+    return token;
+}
+
+void Tokenizer::Fill(std::size_t ahead) {
+    while (count_ <= ahead) {
+        if (count_ > 0 && At(count_ - 1).end) {
+            return;
+        }
+        if (count_ == ring_.size()) {
+            // Moved in by construction, an assignment would keep the default
+            // resource of the new slot
+            std::size_t size = std::max<std::size_t>(2 * ring_.size(), 1);
+            std::vector<Slot> ring;
+            ring.reserve(size);
+            for (std::size_t idx = 0; idx < count_; ++idx) {
+                ring.push_back(std::move(At(idx)));
+            }
+            ring.resize(size);
+            ring_ = std::move(ring);
+            head_ = 0;
+        }
+        Read(At(count_));
+        ++count_;
+    }
+}
+
+Tokenizer::Slot& Tokenizer::At(std::size_t ahead) {
+    return ring_[(head_ + ahead) & (ring_.size() - 1)];
+}
+
+void Tokenizer::Read(Slot& slot) {
+    if (input_ == nullptr) {
+        ReadFromView(slot);
+        return;
+    }
+
     SkipEmpty();
-    is_end_ = StreamEnd();
+    slot.end = StreamEnd();
 
-    if (is_end_) {
+    if (slot.end) {
         return;
     }
 
     char cur_c = input_->get();
+    if (IsDigit(cur_c)) {
+        // Digits are taken from the stream buffer directly, without a sentry per character
+        std::string res_str(1, cur_c);
+        std::streambuf* buffer = input_->rdbuf();
+        const int eof = std::streambuf::traits_type::eof();
+        for (int next = buffer->sgetc(); next != eof && IsDigit(static_cast<char>(next));
+             next = buffer->snextc()) {
+            res_str.push_back(static_cast<char>(next));
+        }
+        big_numbers::BigInteger value(resource_);
+        value.FromChars(res_str.data(), res_str.data() + res_str.size());
+        // emplace, as assigning would keep the cells of the previous number
+        slot.token.emplace<NumberToken>(NumberToken{std::move(value)});
+    } else if (IsIdentifierStart(cur_c)) {
+        std::string name(1, cur_c);
+        while (!StreamEnd() && IsIdentifierChar(static_cast<char>(input_->peek()))) {
+            name.push_back(static_cast<char>(input_->get()));
+        }
+        slot.token = IdentifierToken{std::move(name)};
+    } else {
+        SetOperator(cur_c, slot.token);
+    }
+}
+
+// Same grammar as the stream version: spaces are skipped, a line feed ends the input
+void Tokenizer::ReadFromView(Slot& slot) {
+    while (pos_ != end_ && *pos_ == ' ') {
+        ++pos_;
+    }
+    slot.end = pos_ == end_ || *pos_ == '\n';
+
+    if (slot.end) {
+        return;
+    }
+
+    const char* begin = pos_++;
+    if (IsDigit(*begin)) {
+        pos_ = big_numbers::limbs::ScanDigits(pos_, end_);
+        // Digits go to the number right from the input, without a temporary string
+        big_numbers::BigInteger value(resource_);
+        value.FromChars(begin, pos_);
+        slot.token.emplace<NumberToken>(NumberToken{std::move(value)});
+    } else if (IsIdentifierStart(*begin)) {
+        while (pos_ != end_ && IsIdentifierChar(*pos_)) {
+            ++pos_;
+        }
+        slot.token = IdentifierToken{std::string(begin, pos_)};
+    } else {
+        SetOperator(*begin, slot.token);
+    }
+}
+
+void Tokenizer::SetResource(std::pmr::memory_resource* resource) {
+    resource_ = resource;
+    for (std::size_t idx = 0; idx < count_; ++idx) {
+        Token& token = At(idx).token;
+        if (auto number_ptr = std::get_if<NumberToken>(&token)) {
+            NumberToken moved{big_numbers::BigInteger(number_ptr->value, resource)};
+            token.emplace<NumberToken>(std::move(moved));
+        }
+    }
+}
+
+void Tokenizer::SetOperator(char cur_c, Token& token) {
     if (cur_c == '(') {
-        cur_token_ = BracketToken::kOpen;
+        token = BracketToken::kOpen;
     } else if (cur_c == ')') {
-        cur_token_ = BracketToken::kClose;
+        token = BracketToken::kClose;
     } else if (cur_c == '*') {
-        cur_token_ = MulOpToken::kMult;
+        token = MulOpToken::kMult;
     } else if (cur_c == '/') {
-        cur_token_ = MulOpToken::kDiv;
+        token = MulOpToken::kDiv;
     } else if (cur_c == '%') {
-        cur_token_ = MulOpToken::kModule;
+        token = MulOpToken::kModule;
+    } else if (cur_c == '^') {
+        token = PowOpToken::kPower;
+    } else if (cur_c == ',') {
+        token = CommaToken::kComma;
     } else if (cur_c == '-') {
-        cur_token_ = AddOpToken::kMinus;
+        token = AddOpToken::kMinus;
     } else if (cur_c == '+') {
-        cur_token_ = AddOpToken::kPlus;
-    } else if (std::isdigit(cur_c)) {
-        std::string res_str;
-        res_str.push_back(cur_c);
-        while (!StreamEnd() && std::isdigit(input_->peek())) {
-            cur_c = input_->get();
-            res_str.push_back(cur_c);
-        }
-        cur_token_ = NumberToken{big_numbers::BigInteger(res_str)};
+        token = AddOpToken::kPlus;
+    } else {
+        throw std::runtime_error(std::string("Unexpected character '") + cur_c + "'");
     }
 }
 
-Token Tokenizer::GetToken() {
-    return cur_token_;
-}
-
 }  // namespace calc::tokenizer
@@ -3,22 +3,40 @@
 #include <istream>
 #include <variant>
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <big_integer.hpp>
 
+#include "mapped_file.hpp"
+
 namespace calc::tokenizer {
 
 struct NumberToken {
     big_numbers::BigInteger value;
 };
 
+/// Variable or function name: a letter or '_' followed by letters, digits and '_'
+struct IdentifierToken {
+    std::string name;
+};
+
 enum class BracketToken { kOpen, kClose };
 
 enum class AddOpToken { kPlus, kMinus };
 
 enum class MulOpToken { kMult, kDiv, kModule };
 
-using Token = std::variant<NumberToken, BracketToken, AddOpToken, MulOpToken>;
+/// '^', binds tighter than the other operators and to the right: 2^3^2 = 2^9
+enum class PowOpToken { kPower };
+
+/// ',' between the arguments of a function
+enum class CommaToken { kComma };
+
+using Token = std::variant<NumberToken, IdentifierToken, BracketToken, AddOpToken, MulOpToken,
+                           PowOpToken, CommaToken>;
 
 class Tokenizer {
 public:
@@ -27,6 +45,10 @@ public:
     Tokenizer(std::istream*);
     /// Use this constructor when you can give objects ownership to this class
     Tokenizer(std::unique_ptr<std::istream>&&);
+    /// Reads straight from memory without copying, the text must outlive the tokenizer
+    explicit Tokenizer(std::string_view);
+    /// Reads a mapped file, the tokenizer keeps the mapping alive
+    explicit Tokenizer(MappedFile&&);
 
     Tokenizer(Tokenizer&&);
     Tokenizer(const Tokenizer&) = delete;
@@ -34,20 +56,59 @@ public:
     Tokenizer& operator=(Tokenizer&& other);
     Tokenizer& operator=(const Tokenizer&) = delete;
 
-    bool IsEnd();
+    /// True when the input ends before the token ahead positions after the current one
+    bool IsEnd(std::size_t ahead = 0);
 
     void Next();
 
-    Token GetToken();
+    /// Current token, valid until Next or Take. Must not be called at the end
+    const Token& GetToken();
+    /// Token ahead positions after the current one, read from the input on demand
+    /// and kept until it is consumed. Valid until Next or Take
+    const Token& Peek(std::size_t ahead = 0);
+    /// Token ahead positions after the current one when it is a T, otherwise and at
+    /// the end nullptr. Valid until Next or Take
+    template <class T>
+    const T* PeekIf(std::size_t ahead = 0) {
+        return IsEnd(ahead) ? nullptr : std::get_if<T>(&At(ahead).token);
+    }
+    /// Moves the current token out and goes to the next one, so the cells of a
+    /// number are handed over without a copy
+    Token Take();
+
+    /// Resource for the cells of the numbers read from now on. The current token
+    /// moves to it too, so the previous resource may be released afterwards
+    void SetResource(std::pmr::memory_resource*);
 
 private:
+    /// Token read ahead, end marks the end of the input
+    struct Slot {
+        Token token;
+        bool end{false};
+    };
+
+    /// Reads tokens until the one ahead positions after the current is buffered or
+    /// the input ends
+    void Fill(std::size_t ahead);
+    Slot& At(std::size_t ahead);
+    void Read(Slot&);
+    void ReadFromView(Slot&);
     void SkipEmpty();
     bool StreamEnd();
+    static void SetOperator(char, Token&);
 
     std::unique_ptr<std::istream> u_ptr_{nullptr};
-    std::istream* input_;
-    Token cur_token_{};
-    bool is_end_{false};
+    std::istream* input_{nullptr};
+    // Memory backend, used when input_ is null
+    std::unique_ptr<MappedFile> file_{nullptr};
+    const char* pos_{nullptr};
+    const char* end_{nullptr};
+    std::pmr::memory_resource* resource_{std::pmr::get_default_resource()};
+    /// Ring of the tokens read ahead, the current one at head_. The size is a power
+    /// of two, and slots keep their cells for the tokens read into them later
+    std::vector<Slot> ring_;
+    std::size_t head_{0};
+    std::size_t count_{0};
 };
 
 }  // namespace calc::tokenizer
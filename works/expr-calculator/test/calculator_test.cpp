@@ -1,3 +1,4 @@
+#include "batch.hpp"
 #include "calculator.hpp"
 
 #include <gtest/gtest.h>
@@ -46,6 +47,49 @@ TEST(Calculator, MixedTest) {
     EXPECT_EQ(51, calc.Eval());
 }
 
+TEST(Calculator, Power) {
+    // Binds tighter than * and to the right
+    EXPECT_EQ(512, BuildCalculator("2^3^2").Eval());
+    EXPECT_EQ(64, BuildCalculator("(2^3)^2").Eval());
+    EXPECT_EQ(19, BuildCalculator("2 * 3^2 + 1").Eval());
+    EXPECT_EQ(6, BuildCalculator("10^3 % 7").Eval());
+    EXPECT_EQ("1267650600228229401496703205376", BuildCalculator("2^100").Eval().ToString());
+    EXPECT_EQ(1, BuildCalculator("(0 - 1)^(2^70)").Eval());
+
+    EXPECT_THROW(BuildCalculator("2^(0 - 1)").Eval(), std::invalid_argument);
+    EXPECT_THROW(BuildCalculator("2^").Eval(), std::runtime_error);
+}
+
+TEST(Calculator, Functions) {
+    Calculator calc;
+    EXPECT_EQ(big_numbers::BigInteger("1" + std::string(50, '0')), calc.Eval("sqrt(10^100 + 7)"));
+    EXPECT_EQ(1, calc.Eval("sqrt(3) - 0"));
+    EXPECT_EQ(-4, calc.Eval("root(0 - 80, 1 + 2)"));
+    EXPECT_EQ(100, calc.Eval("root(10^30, 3 * 5) + 0 * gcd(0, 0)"));
+    EXPECT_EQ(6, calc.Eval("gcd(2^10 * 3, 6 * 5^7)"));
+    EXPECT_EQ(42, calc.Eval("lcm(6, 14)"));
+    EXPECT_EQ(5, calc.Eval("modinv(3, 7)"));
+    EXPECT_EQ(8, calc.Eval("gcd(lcm(4, 8), sqrt(64) * 3)"));
+    EXPECT_EQ(25, calc.Eval("sqrt(16)^2 + (9)"));
+
+    EXPECT_THROW(calc.Eval("sqrt(0 - 1)"), std::invalid_argument);
+    EXPECT_THROW(calc.Eval("modinv(6, 9)"), std::invalid_argument);
+    EXPECT_THROW(calc.Eval("modinv(6, 0)"), std::logic_error);
+    EXPECT_THROW(calc.Eval("cbrt(8)"), std::runtime_error);
+    EXPECT_THROW(calc.Eval("gcd(4)"), std::runtime_error);
+    EXPECT_THROW(calc.Eval("sqrt(4, 2)"), std::runtime_error);
+    EXPECT_THROW(calc.Eval("sqrt 4"), std::runtime_error);
+
+    BasicCalculator<big_numbers::FixedBigInteger<128>> fixed;
+    EXPECT_EQ(big_numbers::FixedBigInteger<128>(3), fixed.Eval("gcd(2^100 * 3, 3^40)"));
+    EXPECT_THROW(fixed.Eval("lcm(2^100, 3^40)"), std::overflow_error);
+}
+
+TEST(Calculator, Variables) {
+    Calculator calc = BuildCalculator("2 * x");
+    EXPECT_THROW(calc.Eval(), std::runtime_error);
+}
+
 TEST(Calculator, BigResult) {
     std::string num = "2";
     for (int i = 0; i < 100; ++i) {
@@ -56,4 +100,94 @@ TEST(Calculator, BigResult) {
     EXPECT_EQ("2535301200456458802993406410752", calc.Eval().ToString());
 }
 
+TEST(Calculator, LongProduct) {
+    // 1 * 2 * ... * 1000 taken apart into a balanced tree must equal the left fold
+    std::string expression = "1";
+    big_numbers::BigInteger expected = 1;
+    for (int i = 2; i <= 1000; ++i) {
+        expression += "*" + std::to_string(i);
+        expected *= i;
+    }
+    Calculator calc = BuildCalculator(expression);
+    EXPECT_EQ(expected, calc.Eval());
+
+    // Division splits the runs of multiplications
+    calc = BuildCalculator("3 * 5 * 7 / 2 * 11 * 13 % 1000 * 17 * 19 * 23 / 7 * 2");
+    EXPECT_EQ((((3 * 5 * 7 / 2 * 11 * 13) % 1000) * 17 * 19 * 23) / 7 * 2, calc.Eval());
+}
+
+TEST(Calculator, EvalString) {
+    Calculator calc;
+    EXPECT_EQ(7, calc.Eval("1 + 2 * 3"));
+    EXPECT_THROW(calc.Eval("1 +"), std::runtime_error);
+    EXPECT_EQ(-1, calc.Eval("(2 - 3)"));
+    EXPECT_THROW(calc.Eval("1 2"), std::runtime_error);
+    EXPECT_THROW(calc.Eval("1 + 2 )"), std::runtime_error);
+    // Only the first line is an expression
+    EXPECT_EQ(5, calc.Eval("5\n6"));
+}
+
+TEST(Calculator, Arena) {
+    std::string big(100, '7');
+    Calculator calc;
+    big_numbers::BigInteger expected(big);
+    expected = expected * expected * expected / 3;
+    for (int i = 0; i < 3; ++i) {
+        // The result is copied out of the arena of the evaluation
+        big_numbers::BigInteger res = calc.Eval(big + " * " + big + " * " + big + " / 3");
+        EXPECT_EQ(std::pmr::get_default_resource(), res.Resource());
+        EXPECT_EQ(expected, res);
+        // Failing evaluations release the arena as well
+        EXPECT_THROW(calc.Eval(big + " * (" + big), std::runtime_error);
+    }
+
+    // A number after the expression stays valid when the arena is gone
+    Calculator rest = BuildCalculator("2 * 3 " + big);
+    EXPECT_EQ(6, rest.Eval());
+    EXPECT_EQ(big_numbers::BigInteger(big), rest.Eval());
+}
+
+TEST(Calculator, FixedWidth) {
+    using Fixed = big_numbers::FixedBigInteger<128>;
+    BasicCalculator<Fixed> calc;
+    EXPECT_EQ(Fixed(7), calc.Eval("1 + 2 * 3"));
+    EXPECT_EQ(Fixed(-5), calc.Eval("(2 - 3) * 8 % 5 - 7 / 2 - 4"));
+    EXPECT_EQ(Fixed::Max(), calc.Eval("2^126 - 1 + 2^126"));
+    EXPECT_EQ(Fixed::Min(), calc.Eval("(0 - 2)^127"));
+    EXPECT_EQ("1267650600228229401496703205376", calc.Eval("2^100").ToString());
+
+    EXPECT_THROW(calc.Eval("2^127"), std::overflow_error);
+    EXPECT_THROW(calc.Eval("170141183460469231731687303715884105728"), std::overflow_error);
+    EXPECT_THROW(calc.Eval("3^81 * 3^0"), std::overflow_error);
+    EXPECT_THROW(calc.Eval("1 / 0"), std::logic_error);
+    EXPECT_THROW(calc.Eval("1 +"), std::runtime_error);
+
+    BasicCalculator<big_numbers::FixedBigInteger<512>> wide;
+    EXPECT_EQ(big_numbers::BigInteger(wide.Eval("3^300 / 7^100")),
+              Calculator().Eval("3^300 / 7^100"));
+}
+
+TEST(Calculator, Batch) {
+    std::string input;
+    std::string expected;
+    for (int i = 0; i < 10000; ++i) {
+        input += std::to_string(i) + " * " + std::to_string(i) + " - 1\n";
+        expected += std::to_string(i * i - 1) + "\n";
+    }
+    input += "\n(1 + 2\r\n1 2\n1 + 2 )\n6 / 2\r\n7 % 4";
+    expected += "\nerror: Expected )\nerror: Expected end of expression\n"
+                "error: Expected end of expression\n3\n3\n";
+
+    for (std::size_t threads : {1, 3}) {
+        std::ostringstream from_view;
+        calc::RunBatch(input, from_view, {threads});
+        EXPECT_EQ(expected, from_view.str());
+
+        std::istringstream stream(input);
+        std::ostringstream from_stream;
+        calc::RunBatch(stream, from_stream, {threads});
+        EXPECT_EQ(expected, from_stream.str());
+    }
+}
+
 }  // namespace calc::calculator
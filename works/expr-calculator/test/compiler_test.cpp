@@ -0,0 +1,250 @@
+#include "compiler.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "parallel_evaluator.hpp"
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace calc::compiler {
+
+namespace {
+Program BuildProgram(std::string some_str) {
+    tokenizer::Tokenizer tokenizer(std::make_unique<std::istringstream>(std::move(some_str)));
+    return Compiler(std::move(tokenizer)).Compile();
+}
+
+big_numbers::BigInteger Eval(std::string some_str) {
+    Evaluator evaluator;
+    return evaluator.Run(BuildProgram(std::move(some_str)));
+}
+}  // namespace
+
+TEST(Compiler, Layout) {
+    Program program = BuildProgram("(3 + 4) * 5");
+    ASSERT_EQ(5, program.Size());
+    EXPECT_EQ(3, program.Constants().size());
+
+    // Every instruction reads registers written before it
+    for (std::size_t idx = 0; idx < program.Size(); ++idx) {
+        const Instruction& instruction = program.Instructions()[idx];
+        if (instruction.op != OpCode::kConst) {
+            EXPECT_LT(instruction.lhs, idx);
+            EXPECT_LT(instruction.rhs, idx);
+        }
+    }
+    EXPECT_EQ(OpCode::kMul, program.Instructions().back().op);
+}
+
+TEST(Compiler, Operations) {
+    EXPECT_EQ(123, Eval("123"));
+    EXPECT_EQ(570, Eval("123+456 - 8+0   -        1"));
+    EXPECT_EQ(2, Eval("2*2*2/3*22%7"));
+    EXPECT_EQ(24, Eval("4 + (4 * 5)"));
+    EXPECT_EQ(51, Eval("22 + 16 / 4 - 4 * (17 - 2 * 7 + 3) + 7 * (3 + 4)"));
+    EXPECT_EQ(512, Eval("2^3^2"));
+    EXPECT_EQ(19, Eval("2 * 3^2 + 1"));
+
+    EXPECT_THROW(Eval(""), std::runtime_error);
+    EXPECT_THROW(Eval("(1 + 2"), std::runtime_error);
+    EXPECT_THROW(Eval("1 + *"), std::runtime_error);
+    EXPECT_THROW(Eval("1 / (2 - 2)"), std::logic_error);
+}
+
+TEST(Compiler, Functions) {
+    EXPECT_EQ(big_numbers::BigInteger("1" + std::string(50, '0')), Eval("sqrt(10^100 + 7)"));
+    EXPECT_EQ(8, Eval("gcd(lcm(4, 8), sqrt(64) * 3)"));
+    EXPECT_EQ(-4, Eval("root(0 - 80, 4 - 1)"));
+    EXPECT_THROW(Eval("gcd(4)"), std::runtime_error);
+    EXPECT_THROW(Eval("cbrt(8)"), std::runtime_error);
+
+    // A name without ( stays a variable
+    Program program = BuildProgram("modinv(x, sqrt) + gcd(x, sqrt * 2)");
+    ASSERT_EQ((std::vector<std::string>{"x", "sqrt"}), program.Variables());
+    Evaluator evaluator;
+    EXPECT_EQ(5 + 1, evaluator.Run(program, {3, 7}));
+    EXPECT_THROW(evaluator.Run(program, {6, 9}), std::invalid_argument);
+
+    // Only functions that can't fail are folded
+    Program optimized = Optimize(BuildProgram("sqrt(10^6) + root(x, 2) * modinv(3, 7)"));
+    EXPECT_EQ(1000 + 3 * 5, evaluator.Run(optimized, {9}));
+    EXPECT_THROW(evaluator.Run(optimized, {-9}), std::invalid_argument);
+    EXPECT_THROW(evaluator.Run(Optimize(BuildProgram("modinv(6, 9) * 0"))),
+                 std::invalid_argument);
+    ParallelEvaluator parallel({2, 0});
+    EXPECT_EQ(6, parallel.Run(program, {3, 7}));
+}
+
+TEST(Compiler, RunTwice) {
+    Program program = BuildProgram("(10000000000000000000 - 7) * 3 - 1");
+    Program small = BuildProgram("2 - 3");
+
+    Evaluator evaluator;
+    EXPECT_EQ(big_numbers::BigInteger("29999999999999999978"), evaluator.Run(program));
+    EXPECT_EQ(-1, evaluator.Run(small));
+    EXPECT_EQ(big_numbers::BigInteger("29999999999999999978"), evaluator.Run(program));
+}
+
+TEST(Compiler, Variables) {
+    Program program = BuildProgram("x * (y + 3) - x");
+    ASSERT_EQ((std::vector<std::string>{"x", "y"}), program.Variables());
+    EXPECT_EQ(1, program.VariableIndex("y"));
+    EXPECT_FALSE(program.VariableIndex("z"));
+    // x is loaded once
+    EXPECT_EQ(6, program.Size());
+
+    Evaluator evaluator;
+    EXPECT_EQ(18, evaluator.Run(program, {2, 7}));
+    EXPECT_EQ(-1, evaluator.Run(program, {-1, -1}));
+    EXPECT_THROW(evaluator.Run(program, {2}), std::invalid_argument);
+    EXPECT_THROW(evaluator.Run(program), std::invalid_argument);
+
+    Evaluator::Column xs = {0, 1, 2, big_numbers::BigInteger("100000000000000000000")};
+    Evaluator::Column ys = {5, -3, 0, 1};
+    Evaluator::Column results = evaluator.RunBatch(program, {xs, ys});
+    ASSERT_EQ(4, results.size());
+    EXPECT_EQ(0, results[0]);
+    EXPECT_EQ(-1, results[1]);
+    EXPECT_EQ(4, results[2]);
+    EXPECT_EQ(big_numbers::BigInteger("300000000000000000000"), results[3]);
+
+    EXPECT_THROW(evaluator.RunBatch(program, {xs, {1}}), std::invalid_argument);
+    EXPECT_EQ((Evaluator::Column{7}), evaluator.RunBatch(BuildProgram("3 + 4"), {}));
+}
+
+TEST(Compiler, Optimize) {
+    auto count = [](const Program& program, OpCode op) {
+        std::size_t res = 0;
+        for (const Instruction& instruction : program.Instructions()) {
+            res += instruction.op == op;
+        }
+        return res;
+    };
+    Evaluator evaluator;
+
+    Program folded = Optimize(BuildProgram("2 * 3 + x * 1 + 0 - (4 - 4)"));
+    EXPECT_EQ(3, folded.Size());
+    EXPECT_EQ(10, evaluator.Run(folded, {4}));
+
+    Program shared = Optimize(BuildProgram("(x + y) * (y + x) + (x + y) * (y + x)"));
+    EXPECT_EQ(1, count(shared, OpCode::kSquare));
+    EXPECT_EQ(0, count(shared, OpCode::kMul));
+    EXPECT_EQ(2, count(shared, OpCode::kAdd));
+    EXPECT_EQ(50, evaluator.Run(shared, {2, 3}));
+
+    // Dropped variables keep their place in the bindings
+    Program dropped = Optimize(BuildProgram("x * 0 + y - y % 1"));
+    ASSERT_EQ((std::vector<std::string>{"x", "y"}), dropped.Variables());
+    EXPECT_EQ(1, dropped.Size());
+    EXPECT_EQ(7, evaluator.Run(dropped, {5, 7}));
+
+    // Divisions that can fail stay in the program
+    EXPECT_THROW(evaluator.Run(Optimize(BuildProgram("1 / 0 + 2"))), std::logic_error);
+    Program divides = Optimize(BuildProgram("1 / x * 0"));
+    EXPECT_EQ(0, evaluator.Run(divides, {5}));
+    EXPECT_THROW(evaluator.Run(divides, {0}), std::logic_error);
+
+    Program powers = Optimize(BuildProgram("x^2 + x^1 * y^0 + 2^3^2"));
+    EXPECT_EQ(1, count(powers, OpCode::kSquare));
+    EXPECT_EQ(0, count(powers, OpCode::kPow));
+    EXPECT_EQ(512 + 9 + 3, evaluator.Run(powers, {3, 5}));
+    Program negative = Optimize(BuildProgram("2^(0 - 1) * 0 + x^y"));
+    EXPECT_EQ(2, count(negative, OpCode::kPow));
+    EXPECT_THROW(evaluator.Run(negative, {2, 3}), std::invalid_argument);
+    Program huge = Optimize(BuildProgram("2^(10^30)"));
+    EXPECT_EQ(1, count(huge, OpCode::kPow));
+    EXPECT_THROW(evaluator.Run(huge), std::length_error);
+    EXPECT_THROW(evaluator.Run(Optimize(BuildProgram("0 * 2^(10^30)"))), std::length_error);
+}
+
+TEST(Compiler, OptimizeSameResults) {
+    std::vector<std::string> expressions = {
+        "x * x * x - (x * x) % 7 + 0 * y",
+        "(x - y) * (x - y) / (1 + 0 * x) - (y - x) * (y - x)",
+        "2 * 3 * x + 5 % 3 - x / 1 + (x + 1) * (1 + x) - y * 1",
+        "(7 - 7) * x + x - x + y % 1 + 12 / 5 * y",
+    };
+    std::vector<std::vector<big_numbers::BigInteger>> bindings = {
+        {0, 0}, {3, -4}, {-17, 5}, {big_numbers::BigInteger("123456789012345678901234567"), -1}};
+
+    Evaluator evaluator;
+    for (const std::string& expression : expressions) {
+        Program program = BuildProgram(expression);
+        Program optimized = Optimize(program);
+        EXPECT_LE(optimized.Size(), program.Size());
+        for (const auto& values : bindings) {
+            big_numbers::BigInteger expected = evaluator.Run(program, values);
+            EXPECT_EQ(expected, evaluator.Run(optimized, values)) << expression;
+        }
+    }
+}
+
+TEST(Compiler, BalancedChains) {
+    auto depth = [](const Program& program) {
+        std::vector<std::size_t> depths(program.Size(), 0);
+        for (std::size_t idx = 0; idx < program.Size(); ++idx) {
+            const Instruction& instruction = program.Instructions()[idx];
+            if (instruction.op != OpCode::kConst && instruction.op != OpCode::kVariable) {
+                depths[idx] = 1 + std::max(depths[instruction.lhs], depths[instruction.rhs]);
+            }
+        }
+        return depths.back();
+    };
+
+    std::string sum = "x";
+    std::string product = "x";
+    big_numbers::BigInteger expected_sum = 7;
+    big_numbers::BigInteger expected_product = 7;
+    for (int i = 1; i < 1024; ++i) {
+        sum += (i % 3 == 0 ? " + " : " - ") + std::to_string(i);
+        expected_sum += i % 3 == 0 ? i : -i;
+        product += " * " + std::to_string(i);
+        expected_product *= i;
+    }
+
+    Evaluator evaluator;
+    Program sum_program = BuildProgram(sum);
+    EXPECT_EQ(10, depth(sum_program));
+    EXPECT_EQ(expected_sum, evaluator.Run(sum_program, {7}));
+    Program product_program = BuildProgram(product);
+    EXPECT_EQ(10, depth(product_program));
+    EXPECT_EQ(expected_product, evaluator.Run(product_program, {7}));
+
+    // Negative terms of a round are subtracted from the positive ones
+    EXPECT_EQ(-18, Eval("1 - 2 - 3 - 4 + 5 - 6 - 7 + 8 - 9 + 10 - 11 + 12 - 13 - 14 + 15 + 16 - 17"
+                        " - 18 + 19 + 20 - 21 - 22 + 23"));
+    EXPECT_EQ(13, Eval("2 * 3 * 5 * 7 / 4 * 11 % 17 * 2 * 3 / 5"));
+}
+
+TEST(Compiler, ParallelEvaluator) {
+    std::string expression = "x * y";
+    for (int idx = 1; idx <= 64; ++idx) {
+        std::string number = std::to_string(idx) + std::string(200, '0') + "7";
+        expression += (idx % 3 == 0 ? " - (" : " + (") + number + " - x) * (y + " + number + ")";
+        expression += idx % 5 == 0 ? " / (x - 12345)" : "";
+    }
+    Program program = BuildProgram(expression);
+    Program optimized = Optimize(program);
+    std::vector<big_numbers::BigInteger> values = {big_numbers::BigInteger(std::string(300, '9')),
+                                                   -123456789};
+
+    Evaluator evaluator;
+    big_numbers::BigInteger expected = evaluator.Run(program, values);
+    for (std::size_t threads : {1, 2, 4}) {
+        for (std::size_t min_cost : {0, 1 << 12, 1 << 30}) {
+            ParallelEvaluator parallel({threads, min_cost});
+            EXPECT_EQ(threads, parallel.Threads());
+            EXPECT_EQ(expected, parallel.Run(program, values));
+            EXPECT_EQ(expected, parallel.Run(optimized, values));
+        }
+    }
+
+    ParallelEvaluator parallel({4, 0});
+    EXPECT_EQ(42, parallel.Run(BuildProgram("6 * 7")));
+    EXPECT_THROW(parallel.Run(program, {12345, 1}), std::logic_error);
+    EXPECT_THROW(parallel.Run(program, {1}), std::invalid_argument);
+    // The evaluator is still usable after an error
+    EXPECT_EQ(expected, parallel.Run(program, values));
+}
+
+}  // namespace calc::compiler
@@ -1,6 +1,10 @@
 #include "tokenizer.hpp"
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
 #include <sstream>
 
 namespace calc::tokenizer {
@@ -9,6 +13,10 @@ bool operator==(const NumberToken& lhs, const NumberToken& rhs) {
     return lhs.value == rhs.value;
 }
 
+bool operator==(const IdentifierToken& lhs, const IdentifierToken& rhs) {
+    return lhs.name == rhs.name;
+}
+
 TEST(Tokenizer, Ctor) {
     Tokenizer t{std::make_unique<std::istringstream>()};
 
@@ -36,6 +44,20 @@ TEST(Tokenizer, Expr) {
     }
 }
 
+TEST(Tokenizer, Power) {
+    Tokenizer t{std::string_view("2^x ^3")};
+
+    std::vector<Token> ans = {NumberToken{2}, PowOpToken::kPower, IdentifierToken{"x"},
+                              PowOpToken::kPower, NumberToken{3}};
+
+    for (auto& item : ans) {
+        ASSERT_FALSE(t.IsEnd());
+        ASSERT_EQ(t.GetToken(), item);
+        t.Next();
+    }
+    EXPECT_TRUE(t.IsEnd());
+}
+
 TEST(Tokenizer, ExtraSpaces) {
     Tokenizer t{std::make_unique<std::istringstream>("  1321+2    *  3%    ( 4 / 5)      ")};
 
@@ -51,4 +73,157 @@ TEST(Tokenizer, ExtraSpaces) {
     }
 }
 
+TEST(Tokenizer, Identifiers) {
+    std::string text = "x1*(_y + 3)-Total2z";
+    std::vector<Token> ans = {IdentifierToken{"x1"}, MulOpToken::kMult,
+                              BracketToken::kOpen,   IdentifierToken{"_y"},
+                              AddOpToken::kPlus,     NumberToken{3},
+                              BracketToken::kClose,  AddOpToken::kMinus,
+                              IdentifierToken{"Total2z"}};
+
+    Tokenizer stream{std::make_unique<std::istringstream>(text)};
+    Tokenizer view{std::string_view(text)};
+    for (auto& item : ans) {
+        ASSERT_FALSE(stream.IsEnd());
+        ASSERT_FALSE(view.IsEnd());
+        ASSERT_EQ(stream.GetToken(), item);
+        ASSERT_EQ(view.GetToken(), item);
+        stream.Next();
+        view.Next();
+    }
+    ASSERT_TRUE(stream.IsEnd());
+    ASSERT_TRUE(view.IsEnd());
+}
+
+TEST(Tokenizer, Functions) {
+    Tokenizer t{std::string_view("gcd(x,12)")};
+
+    std::vector<Token> ans = {IdentifierToken{"gcd"}, BracketToken::kOpen, IdentifierToken{"x"},
+                              CommaToken::kComma,     NumberToken{12},     BracketToken::kClose};
+
+    for (auto& item : ans) {
+        ASSERT_FALSE(t.IsEnd());
+        ASSERT_EQ(t.GetToken(), item);
+        t.Next();
+    }
+    EXPECT_TRUE(t.IsEnd());
+}
+
+TEST(Tokenizer, StringView) {
+    std::string_view text = "  1321+2    *  3%    ( 4 / 5)   \n 7";
+    Tokenizer t{text};
+
+    std::vector<Token> ans = {NumberToken{1321},   AddOpToken::kPlus,   NumberToken{2},
+                              MulOpToken::kMult,   NumberToken{3},      MulOpToken::kModule,
+                              BracketToken::kOpen, NumberToken{4},      MulOpToken::kDiv,
+                              NumberToken{5},      BracketToken::kClose};
+
+    for (auto& item : ans) {
+        ASSERT_FALSE(t.IsEnd());
+        ASSERT_EQ(t.GetToken(), item);
+        t.Next();
+    }
+    ASSERT_TRUE(t.IsEnd());
+
+    ASSERT_TRUE(Tokenizer{std::string_view()}.IsEnd());
+}
+
+TEST(Tokenizer, MappedFile) {
+    std::string number(1000, '7');
+    auto path = std::filesystem::temp_directory_path() / "tokenizer_test_mapped_file.txt";
+    std::ofstream(path) << number << "-(1)";
+
+    Tokenizer t{MappedFile(path.string())};
+    std::remove(path.c_str());
+
+    std::vector<Token> ans = {NumberToken{big_numbers::BigInteger(number)}, AddOpToken::kMinus,
+                              BracketToken::kOpen, NumberToken{1}, BracketToken::kClose};
+
+    Tokenizer moved(std::move(t));
+    for (auto& item : ans) {
+        ASSERT_FALSE(moved.IsEnd());
+        ASSERT_EQ(moved.GetToken(), item);
+        moved.Next();
+    }
+    ASSERT_TRUE(moved.IsEnd());
+
+    EXPECT_THROW(MappedFile("/nonexistent/expression.txt"), std::system_error);
+}
+
+TEST(Tokenizer, Lookahead) {
+    std::string number(100, '9');
+    for (bool from_view : {false, true}) {
+        std::string text = "12 + (x * " + number + ") - 3\nignored";
+        Tokenizer t = from_view ? Tokenizer(std::string_view(text))
+                                : Tokenizer(std::make_unique<std::istringstream>(text));
+
+        // Looking ahead reads the tokens once, they stay until consumed
+        ASSERT_FALSE(t.IsEnd(8));
+        ASSERT_TRUE(t.IsEnd(9));
+        EXPECT_EQ(t.Peek(5), Token{NumberToken{big_numbers::BigInteger(number)}});
+        EXPECT_EQ(t.Peek(4), Token{MulOpToken::kMult});
+        EXPECT_EQ(*t.PeekIf<IdentifierToken>(3), IdentifierToken{"x"});
+        EXPECT_EQ(t.PeekIf<NumberToken>(3), nullptr);
+        EXPECT_EQ(t.PeekIf<NumberToken>(9), nullptr);
+        EXPECT_THROW(t.Peek(9), std::logic_error);
+
+        EXPECT_EQ(t.Take(), Token{NumberToken{12}});
+        EXPECT_EQ(t.GetToken(), Token{AddOpToken::kPlus});
+        for (int i = 0; i < 3; ++i) {
+            t.Next();
+        }
+        EXPECT_EQ(t.Peek(4), Token{NumberToken{3}});
+        EXPECT_EQ(t.Take(), Token{MulOpToken::kMult});
+        EXPECT_EQ(t.Take(), Token{NumberToken{big_numbers::BigInteger(number)}});
+        t.Next();
+        t.Next();
+        EXPECT_EQ(t.Take(), Token{NumberToken{3}});
+        ASSERT_TRUE(t.IsEnd());
+        t.Next();
+        ASSERT_TRUE(t.IsEnd());
+        EXPECT_THROW(t.Take(), std::logic_error);
+    }
+
+    EXPECT_THROW(Tokenizer(std::string_view("1 # 2")).Peek(1), std::runtime_error);
+}
+
+TEST(Tokenizer, TakeDoesNotCopy) {
+    // Counts the allocations of number cells
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        std::size_t allocations = 0;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    CountingResource resource;
+    std::string number(200, '3');
+    std::string text = "(" + number + ")";
+    for (int i = 0; i < 5; ++i) {
+        text += " + " + number;
+    }
+    Tokenizer t{std::string_view(text)};
+    t.SetResource(&resource);
+    std::vector<big_numbers::BigInteger> numbers;
+    for (; !t.IsEnd(); t.Next()) {
+        if (t.PeekIf<NumberToken>()) {
+            numbers.push_back(std::get<NumberToken>(t.Take()).value);
+        }
+    }
+    ASSERT_EQ(6, numbers.size());
+    // One allocation per number, while it is parsed
+    EXPECT_EQ(6, resource.allocations);
+    EXPECT_EQ(&resource, numbers.back().Resource());
+}
+
 }  // namespace calc::tokenizer